@@ -0,0 +1,289 @@
+/**
+ * @file AllocTest.cpp
+ * @brief Checks that the figure finder stages do not allocate once the workspace is warm. (make alloc_test)
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#include <new>
+#include <map>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <filesystem>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+#include "FindFigure.h"
+#include "StageStats.h"
+
+namespace {
+
+constexpr int NoStage = -1;
+constexpr int HoughLines = StageStats::stage_count; // cv::HoughLinesP within analyze_lines
+constexpr int CountSlots = StageStats::stage_count + 1;
+
+/**
+ * @brief Allocations attributed to one stage.
+ */
+struct Counts {
+    size_t news = 0;     // calls of operator new, includes the header of every matrix buffer
+    size_t buffers = 0;  // matrix buffers allocated
+    size_t retained = 0; // matrix buffers still alive when the stage returned, workspace (re)allocations
+};
+
+Counts g_Counts[CountSlots];
+int g_Stage = NoStage;
+bool g_InHook = false;
+std::map<const cv::UMatData*, int>* g_Live = nullptr; // matrix buffers allocated while a stage was measured
+
+/**
+ * @brief Matrix allocator counting the buffers allocated by the measured stages.
+ * Buffers are allocated by the standard allocator, but keep this allocator to report their release.
+ */
+class CountingAllocator : public cv::MatAllocator {
+public:
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step, cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override{
+        cv::UMatData* u = cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+        u->prevAllocator = u->currAllocator = this;
+        if(g_Stage != NoStage && !g_InHook){
+            g_InHook = true;
+            g_Counts[g_Stage].buffers++;
+            (*g_Live)[u] = g_Stage;
+            g_InHook = false;
+        }
+        return u;
+    }
+
+    bool allocate(cv::UMatData* data, cv::AccessFlag accessflags, cv::UMatUsageFlags usageFlags) const override{
+        return cv::Mat::getStdAllocator()->allocate(data, accessflags, usageFlags);
+    }
+
+    void deallocate(cv::UMatData* u) const override{
+        if(g_Live && !g_InHook){
+            g_InHook = true;
+            g_Live->erase(u);
+            g_InHook = false;
+        }
+        cv::Mat::getStdAllocator()->deallocate(u);
+    }
+};
+
+/**
+ * @brief Attributes all allocations until the end of the scope to a stage, nested scopes take over.
+ */
+class Measure {
+public:
+    explicit Measure(int stage) : m_Prev(g_Stage), m_Stage(stage){
+        g_Stage = stage;
+    }
+
+    ~Measure(){
+        // buffers of this stage which survived it
+        g_InHook = true;
+        for(auto it = g_Live->begin(); it != g_Live->end();){
+            if(it->second == m_Stage){
+                g_Counts[m_Stage].retained++;
+                it = g_Live->erase(it);
+            }
+            else{
+                ++it;
+            }
+        }
+        g_InHook = false;
+        g_Stage = m_Prev;
+    }
+
+private:
+    int m_Prev;
+    int m_Stage;
+};
+
+/**
+ * @brief Figure finder measuring every overridable stage, the rest of DoWork counts as picture.
+ */
+class MeasuredFindFigure : public FindFigure {
+public:
+    using FindFigure::FindFigure;
+
+    virtual bool DoWork(cv::Mat& pic) override{
+        Measure m(StageStats::picture);
+        return FindFigure::DoWork(pic);
+    }
+    using FindFigure::DoWork;
+
+protected:
+    virtual cv::Mat crop(const cv::Mat & pic) override{
+        Measure m(StageStats::crop);
+        return FindFigure::crop(pic);
+    }
+    virtual cv::Mat correct_brightness(const cv::Mat& roi) override{
+        Measure m(StageStats::correct_brightness);
+        return FindFigure::correct_brightness(roi);
+    }
+    virtual cv::Mat shift(const cv::Mat & roi) override{
+        Measure m(StageStats::shift);
+        return FindFigure::shift(roi);
+    }
+    virtual cv::Mat make_grey(const cv::Mat & shifted) override{
+        Measure m(StageStats::make_grey);
+        return FindFigure::make_grey(shifted);
+    }
+    virtual cv::Mat make_erode(const cv::Mat & grey) override{
+        Measure m(StageStats::make_erode);
+        return FindFigure::make_erode(grey);
+    }
+    virtual cv::Mat make_thresh(const cv::Mat & grey, const cv::Mat & erode_mask) override{
+        Measure m(StageStats::make_thresh);
+        return FindFigure::make_thresh(grey, erode_mask);
+    }
+    virtual contours find_contours_ff(const cv::Mat & thresh) override{
+        Measure m(StageStats::find_contours_ff);
+        return FindFigure::find_contours_ff(thresh);
+    }
+    virtual const std::vector<cv::Vec4i>& analyzeLines(const cv::Mat & pic) override{
+        Measure m(StageStats::analyze_lines);
+        return FindFigure::analyzeLines(pic);
+    }
+    virtual const std::vector<cv::Vec4i>& find_lines(const cv::Mat & edges) override{
+        Measure m(HoughLines);
+        return FindFigure::find_lines(edges);
+    }
+};
+
+/**
+ * @brief Measured stage.
+ */
+struct Measured {
+    int stage;
+    const char* name;
+    bool opencv; // matrix buffers allocated inside OpenCV (pyramids, contours, hough accumulator) are allowed
+};
+
+const Measured g_Measured[] = {{StageStats::crop, "crop", false},
+                               {StageStats::correct_brightness, "correct_brightness", false},
+                               {StageStats::shift, "shift", true},
+                               {StageStats::make_grey, "make_grey", false},
+                               {StageStats::make_erode, "make_erode", false},
+                               {StageStats::make_thresh, "make_thresh", false},
+                               {StageStats::find_contours_ff, "find_contours_ff", true},
+                               {StageStats::analyze_lines, "analyze_lines", false},
+                               {HoughLines, "hough_lines", true},
+                               {StageStats::picture, "picture", false}};
+
+/**
+ * Runs the finder over the pictures and prints the allocations per picture of every stage.
+ * @param title Name of the run.
+ * @param finder Finder to be measured.
+ * @param pics Pictures to be searched.
+ * @return Number of stages which allocated a matrix buffer they were not allowed to, or kept one.
+ */
+size_t run(const char* title, FindFigure& finder, const std::vector<cv::Mat>& pics){
+    std::fill(std::begin(g_Counts), std::end(g_Counts), Counts());
+    for(const auto& p : pics){
+        cv::Mat pic = p; // header only, DoWork replaces it by the figure
+        finder.DoWork(pic);
+    }
+
+    std::printf("%s, %zu pictures, per picture (picture = rest of DoWork: empty check, transformation, normalization)\n", title, pics.size());
+    std::printf("%-20s %12s %12s %12s\n", "stage", "new", "buffers", "retained");
+    size_t failed = 0;
+    for(const auto& m : g_Measured){
+        const Counts& c = g_Counts[m.stage];
+        bool ok = c.retained == 0 && (m.opencv || c.buffers == 0);
+        std::printf("%-20s %12.1f %12.1f %12.1f%s\n", m.name, double(c.news) / pics.size(),
+                    double(c.buffers) / pics.size(), double(c.retained) / pics.size(), ok ? "" : "  <- allocates");
+        failed += !ok;
+    }
+    std::printf("\n");
+    return failed;
+}
+
+} // namespace
+
+void* operator new(size_t size){
+    if(g_Stage != NoStage && !g_InHook)
+        g_Counts[g_Stage].news++;
+    if(void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept{
+    std::free(p);
+}
+
+/**
+ * Usage: alloc_test [background] [picture folder]
+ * After the first picture with a figure (OpenCV sets up its tables on first use) the whole folder
+ * is processed again. No stage may keep a matrix buffer it allocated, the workspace is reused, and
+ * only the OpenCV internals of the mean shift, the contour and the line search may allocate
+ * temporary matrix buffers. Calls of operator new are only reported, OpenCV allocates its line
+ * buffers (filters, remapping) on every call.
+ */
+int main(int argc, char** argv){
+    const std::filesystem::path bgFile = argc > 1 ? argv[1] : "./pic/Other/image_100.jpg";
+    const std::filesystem::path folder = argc > 2 ? argv[2] : "./pic/0-Normal";
+
+    // single threaded, worker threads of OpenCV would allocate on their own
+    cv::setNumThreads(0);
+
+    cv::Mat bg = cv::imread(bgFile.string(), cv::IMREAD_COLOR);
+    if(bg.empty()){
+        std::fprintf(stderr, "Could not read the background: %s\n", bgFile.string().c_str());
+        return EXIT_FAILURE;
+    }
+    std::vector<std::filesystem::path> files;
+    for(const auto& entry : std::filesystem::directory_iterator(folder)){
+        if(entry.is_regular_file())
+            files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    std::vector<cv::Mat> pics;
+    for(const auto& f : files){
+        cv::Mat pic = cv::imread(f.string(), cv::IMREAD_COLOR);
+        if(!pic.empty() && pic.size() == bg.size())
+            pics.push_back(pic);
+    }
+    if(pics.empty()){
+        std::fprintf(stderr, "No pictures of the background size in: %s\n", folder.string().c_str());
+        return EXIT_FAILURE;
+    }
+
+    static CountingAllocator allocator; // outlives every buffer it allocated
+    std::map<const cv::UMatData*, int> live;
+    g_Live = &live;
+    cv::Mat::setDefaultAllocator(&allocator);
+
+    MeasuredFindFigure finder(bg);
+
+    // warm up until the first picture with a figure ran through every stage
+    bool found = false;
+    for(size_t i = 0; i < pics.size() && !found; i++){
+        cv::Mat pic = pics[i];
+        found = finder.DoWork(pic);
+    }
+    if(!found){
+        std::fprintf(stderr, "No figure found in: %s\n", folder.string().c_str());
+        return EXIT_FAILURE;
+    }
+    size_t failed = run("all pictures", finder, pics);
+
+    cv::Mat::setDefaultAllocator(nullptr);
+    g_Live = nullptr;
+    if(failed != 0){
+        std::fprintf(stderr, "FAILED: %zu stages allocated matrix buffers after the first picture\n", failed);
+        return EXIT_FAILURE;
+    }
+    std::printf("OK: no stage allocated a matrix buffer of its own after the first picture\n");
+    return EXIT_SUCCESS;
+}
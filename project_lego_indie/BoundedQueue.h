@@ -0,0 +1,107 @@
+/**
+ * @file BoundedQueue.h
+ * @brief Thread safe first in first out queue with limited capacity.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <Object.h>
+
+/**
+ * @brief Bounded producer/consumer queue.
+ * Producers block while the queue is full (or use TryPush()), consumers block while it is empty.
+ * After Close() was called no more elements are accepted and consumers drain the rest.
+ */
+template<typename T>
+class BoundedQueue : public giri::Object<BoundedQueue<T>> {
+public:
+
+    /**
+     * CTor
+     * @param capacity Maximum number of queued elements.
+     */
+    explicit BoundedQueue(size_t capacity) : m_Capacity(capacity > 0 ? capacity : 1){};
+
+    /**
+     * Appends an element, blocks while the queue is full.
+     * @param val Element to be appended.
+     * @return false if the queue was closed, the element is dropped then.
+     */
+    bool Push(T val){
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_NotFull.wait(lock, [this](){ return m_Closed || m_Queue.size() < m_Capacity; });
+        if(m_Closed)
+            return false;
+        m_Queue.push_back(std::move(val));
+        lock.unlock();
+        m_NotEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * Appends an element if the queue has room, never blocks.
+     * @param val [in/out] Element to be appended, only moved from if it was appended.
+     * @return false if the queue is full or was closed.
+     */
+    bool TryPush(T& val){
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        if(m_Closed || m_Queue.size() >= m_Capacity)
+            return false;
+        m_Queue.push_back(std::move(val));
+        lock.unlock();
+        m_NotEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * Removes the oldest element, blocks while the queue is empty.
+     * @param val [out] Removed element.
+     * @return false if the queue was closed and is empty.
+     */
+    bool Pop(T& val){
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_NotEmpty.wait(lock, [this](){ return m_Closed || !m_Queue.empty(); });
+        if(m_Queue.empty())
+            return false;
+        val = std::move(m_Queue.front());
+        m_Queue.pop_front();
+        lock.unlock();
+        m_NotFull.notify_one();
+        return true;
+    }
+
+    /**
+     * Stops accepting elements and wakes up all waiting threads.
+     */
+    void Close(){
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Closed = true;
+        }
+        m_NotFull.notify_all();
+        m_NotEmpty.notify_all();
+    }
+
+    using SPtr = std::shared_ptr<BoundedQueue<T>>;
+    using UPtr = std::unique_ptr<BoundedQueue<T>>;
+    using WPtr = std::weak_ptr<BoundedQueue<T>>;
+
+private:
+    size_t m_Capacity;
+    bool m_Closed = false;
+    std::deque<T> m_Queue;
+    std::mutex m_Mutex;
+    std::condition_variable m_NotFull;
+    std::condition_variable m_NotEmpty;
+};
+
+#endif // BOUNDEDQUEUE_H
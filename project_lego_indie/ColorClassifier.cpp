@@ -0,0 +1,153 @@
+/**
+ * @file ColorClassifier.cpp
+ * @brief Class which classifies BGR pixels into the HSV color ranges of the color feature finders using a lookup table.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#include "ColorClassifier.h"
+
+#include <mutex>
+
+namespace {
+
+/**
+ * Integer BGR to HSV conversion, identical to cv::cvtColor(..., cv::COLOR_BGR2HSV) for 8 bit pictures.
+ */
+class HsvConverter {
+public:
+    HsvConverter(){
+        m_SDiv[0] = m_HDiv[0] = 0;
+        for(int i = 1; i < 256; i++){
+            m_SDiv[i] = cv::saturate_cast<int>((255 << m_Shift) / (1. * i));
+            m_HDiv[i] = cv::saturate_cast<int>((180 << m_Shift) / (6. * i));
+        }
+    }
+
+    void operator()(int b, int g, int r, int& h, int& s, int& v) const{
+        v = std::max(b, std::max(g, r));
+        int vmin = std::min(b, std::min(g, r));
+        int diff = v - vmin;
+        int vr = v == r ? -1 : 0;
+        int vg = v == g ? -1 : 0;
+
+        s = (diff * m_SDiv[v] + (1 << (m_Shift - 1))) >> m_Shift;
+        h = (vr & (g - b)) + (~vr & ((vg & (b - r + 2 * diff)) + ((~vg) & (r - g + 4 * diff))));
+        h = (h * m_HDiv[diff] + (1 << (m_Shift - 1))) >> m_Shift;
+        h += h < 0 ? 180 : 0;
+    }
+
+private:
+    static constexpr int m_Shift = 12;
+    int m_SDiv[256];
+    int m_HDiv[256];
+};
+
+const HsvConverter& hsvConverter(){
+    static const HsvConverter conv;
+    return conv;
+}
+
+} // namespace
+
+bool ColorClassifier::Bounds::operator==(const Bounds& o) const{
+    return std::equal(lower, lower + 3, o.lower) && std::equal(upper, upper + 3, o.upper);
+}
+
+ColorClassifier::Bounds ColorClassifier::toBounds(const cv::Scalar& lower, const cv::Scalar& upper){
+    Bounds b;
+    for(int c = 0; c < 3; c++){
+        b.lower[c] = cv::saturate_cast<int>(lower[c]);
+        b.upper[c] = cv::saturate_cast<int>(upper[c]);
+    }
+    return b;
+}
+
+std::shared_ptr<ColorClassifier> ColorClassifier::Create(const std::vector<ColorRange>& ranges){
+    static std::mutex mtx;
+    static std::vector<SPtr> cache;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    for(const auto& c : cache){
+        bool same = true;
+        for(const auto& range : ranges)
+            same = same && c->GetIndex(range.lower, range.upper) >= 0;
+        if(same)
+            return c;
+    }
+    cache.push_back(std::make_shared<ColorClassifier>(ranges));
+    return cache.back();
+}
+
+ColorClassifier::ColorClassifier(const std::vector<ColorRange>& ranges){
+    for(const auto& range : ranges){
+        if(GetIndex(range.lower, range.upper) < 0)
+            m_Ranges.push_back(toBounds(range.lower, range.upper));
+    }
+    CV_Assert(m_Ranges.size() <= MaxRanges);
+
+    // every cell covers (1 << m_QuantShift)^3 colors, check which ranges contain all or some of them
+    const int cells = 1 << m_QuantBits;
+    const int step = 1 << m_QuantShift;
+    m_Lut.resize(cells * cells * cells);
+    cv::parallel_for_(cv::Range(0, cells), [&](const cv::Range& blues){
+        for(int cb = blues.start; cb < blues.end; cb++)
+            for(int cg = 0; cg < cells; cg++)
+                for(int cr = 0; cr < cells; cr++){
+                    uint8_t all = 0xFF, any = 0;
+                    for(int b = cb * step; b < (cb + 1) * step; b++)
+                        for(int g = cg * step; g < (cg + 1) * step; g++)
+                            for(int r = cr * step; r < (cr + 1) * step; r++){
+                                uint8_t m = match(b, g, r);
+                                all &= m;
+                                any |= m;
+                            }
+                    m_Lut[(cb << (2 * m_QuantBits)) | (cg << m_QuantBits) | cr] = all | ((any & ~all) << 8);
+                }
+    });
+}
+
+int ColorClassifier::GetIndex(const cv::Scalar& lower, const cv::Scalar& upper) const{
+    auto bounds = toBounds(lower, upper);
+    for(size_t i = 0; i < m_Ranges.size(); i++){
+        if(m_Ranges[i] == bounds)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+uint8_t ColorClassifier::match(int b, int g, int r) const{
+    int hsv[3];
+    hsvConverter()(b, g, r, hsv[0], hsv[1], hsv[2]);
+    uint8_t m = 0;
+    for(size_t i = 0; i < m_Ranges.size(); i++){
+        const auto& range = m_Ranges[i];
+        if(hsv[0] >= range.lower[0] && hsv[0] <= range.upper[0] &&
+           hsv[1] >= range.lower[1] && hsv[1] <= range.upper[1] &&
+           hsv[2] >= range.lower[2] && hsv[2] <= range.upper[2])
+            m |= 1 << i;
+    }
+    return m;
+}
+
+void ColorClassifier::Classify(const cv::Mat& bgr, cv::Mat& classes) const{
+    CV_Assert(bgr.type() == CV_8UC3);
+    classes.create(bgr.size(), CV_8UC1);
+    for(int y = 0; y < bgr.rows; y++)
+        ClassifyRow(bgr.ptr<uchar>(y), classes.ptr<uchar>(y), bgr.cols);
+}
+
+void ColorClassifier::ClassifyRow(const uchar* bgr, uchar* classes, int n) const{
+    for(int x = 0; x < n; x++, bgr += 3){
+        uint16_t e = m_Lut[((bgr[0] >> m_QuantShift) << (2 * m_QuantBits)) |
+                           ((bgr[1] >> m_QuantShift) << m_QuantBits) |
+                           (bgr[2] >> m_QuantShift)];
+        uint8_t m = e & 0xFF;
+        if(e >> 8)
+            m |= match(bgr[0], bgr[1], bgr[2]) & (e >> 8);
+        classes[x] = m;
+    }
+}
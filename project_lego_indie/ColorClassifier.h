@@ -0,0 +1,100 @@
+/**
+ * @file ColorClassifier.h
+ * @brief Class which classifies BGR pixels into the HSV color ranges of the color feature finders using a lookup table.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#ifndef COLORCLASSIFIER_H
+#define COLORCLASSIFIER_H
+
+#include <opencv2/core.hpp>
+#include <Object.h>
+
+#include <vector>
+#include <cstdint>
+
+/**
+ * @brief Inclusive HSV color range, same semantic as cv::inRange on a cv::COLOR_BGR2HSV converted picture.
+ */
+struct ColorRange {
+    cv::Scalar lower;
+    cv::Scalar upper;
+};
+
+/**
+ * @brief Lookup table based color classifier.
+ * Maps every BGR pixel to a bitmask of the color ranges it falls into (bit n == n-th range) in
+ * one pass, without converting the picture to HSV. The lookup table is quantized to 5 bits per
+ * channel, table cells which are only partially covered by a range are resolved with an exact
+ * per pixel HSV conversion, so results are identical to cv::cvtColor + cv::inRange.
+ */
+class ColorClassifier : public giri::Object<ColorClassifier> {
+public:
+    /**
+     * Maximum number of distinct color ranges.
+     */
+    static constexpr int MaxRanges = 8;
+
+    /**
+     * Returns a classifier for the given ranges. Classifiers are immutable and cached, so all
+     * threads asking for the same ranges share one lookup table.
+     * @param ranges Color ranges to classify, duplicates are merged.
+     */
+    static std::shared_ptr<ColorClassifier> Create(const std::vector<ColorRange>& ranges);
+
+    /**
+     * CTor, builds the lookup table. Prefer Create() which shares tables.
+     * @param ranges Color ranges to classify, duplicates are merged.
+     */
+    explicit ColorClassifier(const std::vector<ColorRange>& ranges);
+
+    /**
+     * @param lower Lower HSV bound.
+     * @param upper Upper HSV bound.
+     * @return Bit index of the given range, -1 if this classifier does not know the range.
+     */
+    int GetIndex(const cv::Scalar& lower, const cv::Scalar& upper) const;
+
+    /**
+     * Classifies every pixel of the given picture.
+     * @param bgr [in] Picture to classify. (CV_8UC3, BGR)
+     * @param classes [out] Bitmask of matching ranges per pixel. (CV_8UC1)
+     */
+    void Classify(const cv::Mat& bgr, cv::Mat& classes) const;
+
+    /**
+     * Classifies one row of pixels.
+     * @param bgr [in] Row of a CV_8UC3 BGR picture.
+     * @param classes [out] Bitmask of matching ranges per pixel.
+     * @param n Number of pixels in the row.
+     */
+    void ClassifyRow(const uchar* bgr, uchar* classes, int n) const;
+
+    using SPtr = std::shared_ptr<ColorClassifier>;
+    using UPtr = std::unique_ptr<ColorClassifier>;
+    using WPtr = std::weak_ptr<ColorClassifier>;
+
+private:
+    struct Bounds {
+        int lower[3];
+        int upper[3];
+        bool operator==(const Bounds& o) const;
+    };
+
+    static Bounds toBounds(const cv::Scalar& lower, const cv::Scalar& upper);
+    uint8_t match(int b, int g, int r) const;
+
+    static constexpr int m_QuantShift = 3;
+    static constexpr int m_QuantBits = 8 - m_QuantShift;
+
+    std::vector<Bounds> m_Ranges;
+
+    // low byte: ranges containing the whole cell, high byte: ranges containing a part of the cell
+    std::vector<uint16_t> m_Lut;
+};
+
+#endif // COLORCLASSIFIER_H
@@ -0,0 +1,8 @@
+// generated by --embed, rebuild with make embed
+// nothing embedded, background and templates are read from files
+#ifndef Embedded_H
+#define Embedded_H
+const EmbeddedPicture embedded_pictures[] = {
+	{nullptr, 0, 0, nullptr}
+};
+#endif
@@ -0,0 +1,52 @@
+/**
+ * @file EmbeddedPictures.cpp
+ * @brief Decoded pictures compiled into the executable, so no files have to be read at startup.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#include "EmbeddedPictures.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "Embedded.h" // generated by make embed, needs EmbeddedPicture
+
+cv::Mat getEmbeddedPicture(const std::string& name){
+    for(const auto& emb : embedded_pictures){
+        if(emb.name && name == emb.name){
+            // the embedded data is read only, inspectors get their own copy
+            return cv::Mat(emb.height, emb.width, CV_8UC3, const_cast<unsigned char*>(emb.data)).clone();
+        }
+    }
+    return cv::Mat();
+}
+
+bool writeEmbeddedPictures(const std::filesystem::path& header, const std::vector<std::pair<std::string, cv::Mat>>& pics){
+    std::FILE* f = std::fopen(header.string().c_str(), "w");
+    if(!f)
+        return false;
+
+    std::fprintf(f, "// generated by --embed, rebuild with make embed\n");
+    std::fprintf(f, "#ifndef Embedded_H\n#define Embedded_H\n");
+    for(const auto& pic : pics){
+        const cv::Mat& m = pic.second;
+        std::fprintf(f, "const unsigned char embedded_%s[] = {\n/* W=%d H=%d D=3 */\n", pic.first.c_str(), m.cols, m.rows);
+        for(int y = 0; y < m.rows; y++){
+            const uchar* p = m.ptr<uchar>(y);
+            for(int x = 0; x < m.cols * 3; x++)
+                std::fprintf(f, (x % 24 == 23 || x == m.cols * 3 - 1) ? "0x%02x,\n" : "0x%02x,", p[x]);
+        }
+        std::fprintf(f, "};\n");
+    }
+    std::fprintf(f, "const EmbeddedPicture embedded_pictures[] = {\n");
+    for(const auto& pic : pics)
+        std::fprintf(f, "\t{\"%s\", %d, %d, embedded_%s},\n", pic.first.c_str(), pic.second.cols, pic.second.rows, pic.first.c_str());
+    std::fprintf(f, "\t{nullptr, 0, 0, nullptr}\n};\n#endif\n");
+
+    bool ok = !std::ferror(f);
+    return (std::fclose(f) == 0) && ok;
+}
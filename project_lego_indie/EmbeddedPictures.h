@@ -0,0 +1,45 @@
+/**
+ * @file EmbeddedPictures.h
+ * @brief Decoded pictures compiled into the executable, so no files have to be read at startup.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#ifndef EMBEDDEDPICTURES_H
+#define EMBEDDEDPICTURES_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <filesystem>
+#include <opencv2/core.hpp>
+
+/**
+ * @brief One embedded picture, BGR pixels without row padding.
+ */
+struct EmbeddedPicture {
+    const char* name;
+    int width;
+    int height;
+    const unsigned char* data;
+};
+
+/**
+ * Looks up an embedded picture.
+ * @param name Name the picture was embedded with.
+ * @return Copy of the picture, empty if the executable was built without it.
+ */
+cv::Mat getEmbeddedPicture(const std::string& name);
+
+/**
+ * Writes pictures into a header to be compiled into the executable in place of Embedded.h.
+ * @param header Header file to be created, an existing file gets replaced.
+ * @param pics Name and picture (CV_8UC3) of every picture to be embedded.
+ * @return false if the header could not be written.
+ */
+bool writeEmbeddedPictures(const std::filesystem::path& header, const std::vector<std::pair<std::string, cv::Mat>>& pics);
+
+#endif // EMBEDDEDPICTURES_H
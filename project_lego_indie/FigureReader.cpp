@@ -0,0 +1,79 @@
+/**
+ * @file FigureReader.cpp
+ * @brief Class which reads normalized figures from a memory mapped figure file.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#include "FigureReader.h"
+
+#include <cstring>
+
+FigureReader::FigureReader(const std::filesystem::path& file){
+    try{
+        m_File.open(file.string());
+    }
+    catch(const std::exception&){
+        return;
+    }
+    m_Valid = parse();
+}
+
+bool FigureReader::parse(){
+    const char* data = m_File.data();
+    size_t size = m_File.size();
+    if(size < sizeof(m_Header))
+        return false;
+    std::memcpy(&m_Header, data, sizeof(m_Header));
+
+    FigureFileHeader expected;
+    if(std::memcmp(m_Header.magic, expected.magic, sizeof(expected.magic)) != 0 ||
+       m_Header.channels != 3 || m_Header.width == 0 || m_Header.height == 0 ||
+       m_Header.count > (size - sizeof(m_Header)) / m_Header.stride() ||
+       m_Header.indexOffset != sizeof(m_Header) + m_Header.count * m_Header.stride())
+        return false;
+
+    // index: uint32 name length, name, float location[5] per figure
+    size_t pos = m_Header.indexOffset;
+    for(uint64_t i = 0; i < m_Header.count; i++){
+        uint32_t len;
+        float loc[5];
+        if(size - pos < sizeof(len))
+            return false;
+        std::memcpy(&len, data + pos, sizeof(len));
+        pos += sizeof(len);
+        if(size - pos < len + sizeof(loc))
+            return false;
+        m_Names.emplace_back(data + pos, len);
+        pos += len;
+        std::memcpy(loc, data + pos, sizeof(loc));
+        pos += sizeof(loc);
+        m_Locations.emplace_back(cv::Point2f(loc[0], loc[1]), cv::Size2f(loc[2], loc[3]), loc[4]);
+    }
+    return true;
+}
+
+bool FigureReader::IsOpened() const{
+    return m_Valid;
+}
+
+size_t FigureReader::GetCount() const{
+    return m_Valid ? m_Names.size() : 0;
+}
+
+const std::string& FigureReader::GetName(size_t i) const{
+    return m_Names.at(i);
+}
+
+const cv::RotatedRect& FigureReader::GetLocation(size_t i) const{
+    return m_Locations.at(i);
+}
+
+cv::Mat FigureReader::GetFigure(size_t i) const{
+    CV_Assert(i < GetCount());
+    const char* fig = m_File.data() + sizeof(m_Header) + i * m_Header.stride();
+    return cv::Mat(m_Header.height, m_Header.width, CV_8UC3, const_cast<char*>(fig));
+}
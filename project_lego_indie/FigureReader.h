@@ -0,0 +1,78 @@
+/**
+ * @file FigureReader.h
+ * @brief Class which reads normalized figures from a memory mapped figure file.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#ifndef FIGUREREADER_H
+#define FIGUREREADER_H
+
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <opencv2/core.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <Object.h>
+
+#include "FigureWriter.h"
+
+/**
+ * @brief Figure file reader.
+ * The file is mapped into memory, figures are returned as views of the mapping.
+ */
+class FigureReader : public giri::Object<FigureReader> {
+public:
+
+    /**
+     * CTor
+     * @param file Figure file created by FigureWriter.
+     */
+    explicit FigureReader(const std::filesystem::path& file);
+
+    /**
+     * @return true if the file could be mapped and has a valid layout.
+     */
+    bool IsOpened() const;
+
+    /**
+     * @return Number of figures within the file.
+     */
+    size_t GetCount() const;
+
+    /**
+     * @param i Figure index.
+     * @return Source of the figure.
+     */
+    const std::string& GetName(size_t i) const;
+
+    /**
+     * @param i Figure index.
+     * @return Location of the figure within its source picture.
+     */
+    const cv::RotatedRect& GetLocation(size_t i) const;
+
+    /**
+     * @param i Figure index.
+     * @return View of the figure within the mapping, read only (copy it before modifying).
+     */
+    cv::Mat GetFigure(size_t i) const;
+
+    using SPtr = std::shared_ptr<FigureReader>;
+    using UPtr = std::unique_ptr<FigureReader>;
+    using WPtr = std::weak_ptr<FigureReader>;
+
+private:
+    bool parse();
+
+    boost::iostreams::mapped_file_source m_File;
+    FigureFileHeader m_Header;
+    std::vector<std::string> m_Names;
+    std::vector<cv::RotatedRect> m_Locations;
+    bool m_Valid = false;
+};
+
+#endif // FIGUREREADER_H
@@ -0,0 +1,81 @@
+/**
+ * @file FigureWriter.cpp
+ * @brief Class which exports normalized figures into one memory mappable file.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#include "FigureWriter.h"
+
+#include <cstring>
+
+static_assert(sizeof(FigureFileHeader) == 64, "figure file header has to be 64 bytes");
+
+FigureWriter::FigureWriter(const std::filesystem::path& file) : m_Out(file, std::ios::binary | std::ios::trunc){
+    // placeholder, the final header is written by Close()
+    m_Out.write(reinterpret_cast<const char*>(&m_Header), sizeof(m_Header));
+}
+
+FigureWriter::~FigureWriter(){
+    Close();
+}
+
+bool FigureWriter::IsOpened() const{
+    return m_Out.is_open();
+}
+
+void FigureWriter::Write(size_t idx, std::vector<Entry> figures){
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if(idx != m_Next){
+        // the pictures may be worker buffers, keep own copies until the predecessors arrived
+        for(auto& fig : figures)
+            fig.pic = fig.pic.clone();
+        m_Pending[idx] = std::move(figures);
+        return;
+    }
+
+    for(const auto& fig : figures)
+        append(fig);
+    m_Next++;
+    for(auto it = m_Pending.begin(); it != m_Pending.end() && it->first == m_Next; it = m_Pending.erase(it), m_Next++){
+        for(const auto& fig : it->second)
+            append(fig);
+    }
+}
+
+void FigureWriter::append(const Entry& fig){
+    CV_Assert(fig.pic.type() == CV_8UC3 && fig.pic.cols == static_cast<int>(m_Header.width) && fig.pic.rows == static_cast<int>(m_Header.height));
+    for(int y = 0; y < fig.pic.rows; y++)
+        m_Out.write(reinterpret_cast<const char*>(fig.pic.ptr(y)), fig.pic.cols * 3);
+
+    uint32_t len = static_cast<uint32_t>(fig.name.size());
+    const auto& l = fig.location;
+    float loc[5] = {l.center.x, l.center.y, l.size.width, l.size.height, l.angle};
+    size_t pos = m_Index.size();
+    m_Index.resize(pos + sizeof(len) + len + sizeof(loc));
+    std::memcpy(&m_Index[pos], &len, sizeof(len));
+    std::memcpy(&m_Index[pos + sizeof(len)], fig.name.data(), len);
+    std::memcpy(&m_Index[pos + sizeof(len) + len], loc, sizeof(loc));
+    m_Header.count++;
+}
+
+void FigureWriter::Close(){
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if(!m_Out.is_open())
+        return;
+
+    // pictures which never got their predecessors (aborted run) are written anyway
+    for(const auto& pending : m_Pending)
+        for(const auto& fig : pending.second)
+            append(fig);
+    m_Pending.clear();
+
+    m_Header.indexOffset = sizeof(m_Header) + m_Header.count * m_Header.stride();
+    m_Out.write(m_Index.data(), m_Index.size());
+    m_Out.seekp(0);
+    m_Out.write(reinterpret_cast<const char*>(&m_Header), sizeof(m_Header));
+    m_Out.close();
+}
@@ -0,0 +1,102 @@
+/**
+ * @file FigureWriter.h
+ * @brief Class which exports normalized figures into one memory mappable file.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#ifndef FIGUREWRITER_H
+#define FIGUREWRITER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <fstream>
+#include <filesystem>
+#include <opencv2/core.hpp>
+#include <Object.h>
+
+/**
+ * @brief Layout of a figure file.
+ * header | count figures of fixed stride (Width * Height * 3 bytes, BGR) | index
+ * The index holds one entry per figure: uint32 name length, name, float location[5] (cx, cy, w, h, angle).
+ * All values are stored in host byte order.
+ */
+struct FigureFileHeader {
+    char magic[4] = {'L', 'N', 'F', '1'};
+    uint32_t width = 124;
+    uint32_t height = 200;
+    uint32_t channels = 3;
+    uint64_t count = 0;
+    uint64_t indexOffset = 0;
+    uint64_t reserved[4] = {}; // pads the header to 64 bytes, keeps the figures aligned
+
+    size_t stride() const { return static_cast<size_t>(width) * height * channels; }
+};
+
+/**
+ * @brief Figure file writer.
+ * Figures are written in the order of their source pictures, even if the pictures are
+ * inspected by multiple threads.
+ */
+class FigureWriter : public giri::Object<FigureWriter> {
+public:
+
+    /**
+     * @brief One normalized figure.
+     */
+    struct Entry {
+        std::string name;         // source of the figure
+        cv::RotatedRect location; // location within the source picture
+        cv::Mat pic;              // normalized figure
+    };
+
+    /**
+     * CTor
+     * @param file File to be created, an existing file gets replaced.
+     */
+    explicit FigureWriter(const std::filesystem::path& file);
+
+    /**
+     * DTor, finishes the file.
+     */
+    virtual ~FigureWriter();
+
+    /**
+     * @return true if the file could be created.
+     */
+    bool IsOpened() const;
+
+    /**
+     * Adds the figures of one source picture, thread safe. Has to be called exactly once per
+     * source picture, also if it contains no figure at all.
+     * @param idx Index of the source picture, starting with 0.
+     * @param figures Figures found on the picture.
+     */
+    void Write(size_t idx, std::vector<Entry> figures);
+
+    /**
+     * Writes the index and the final header. Called by the destructor if not done before.
+     */
+    void Close();
+
+    using SPtr = std::shared_ptr<FigureWriter>;
+    using UPtr = std::unique_ptr<FigureWriter>;
+    using WPtr = std::weak_ptr<FigureWriter>;
+
+private:
+    void append(const Entry& fig);
+
+    std::ofstream m_Out;
+    FigureFileHeader m_Header;
+    std::vector<char> m_Index;
+    std::map<size_t, std::vector<Entry>> m_Pending; // pictures finished before their predecessors
+    size_t m_Next = 0;
+    std::mutex m_Mutex;
+};
+
+#endif // FIGUREWRITER_H
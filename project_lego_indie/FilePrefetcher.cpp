@@ -0,0 +1,114 @@
+/**
+ * @file FilePrefetcher.cpp
+ * @brief Class which reads the next files on background threads.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#include "FilePrefetcher.h"
+
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+
+bool FilePrefetcher::ReadFile(const std::filesystem::path& f, std::vector<uchar>& data){
+    data.clear();
+    // directories open fine but report a bogus size
+    std::error_code ec;
+    if(!std::filesystem::is_regular_file(f, ec))
+        return false;
+    std::ifstream in(f, std::ios::binary | std::ios::ate);
+    if(!in)
+        return false;
+    std::streamoff size = in.tellg();
+    if(size < 0)
+        return false;
+    data.resize(static_cast<size_t>(size));
+    in.seekg(0);
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(data.data()), data.size()));
+}
+
+FilePrefetcher::FilePrefetcher(std::vector<std::filesystem::path> files, size_t readers, size_t depth) :
+    m_Files(std::move(files)), m_Depth(depth > 0 ? depth : 1)
+{
+    for(size_t i = 0; i < std::max<size_t>(readers, 1); i++)
+        m_Readers.emplace_back(&FilePrefetcher::read, this);
+}
+
+FilePrefetcher::~FilePrefetcher(){
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_CanRead.notify_all();
+    for(auto& t : m_Readers)
+        t.join();
+}
+
+void FilePrefetcher::read(){
+    std::vector<uchar> buf;
+    for(;;){
+        size_t i;
+        {
+            // stay within depth files of the consumers
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_CanRead.wait(lock, [this](){ return m_Stop || m_NextRead >= m_Files.size() || m_NextRead < m_NextTaken + m_Depth; });
+            if(m_Stop || m_NextRead >= m_Files.size())
+                return;
+            i = m_NextRead++;
+            if(!m_Free.empty()){
+                buf = std::move(m_Free.back());
+                m_Free.pop_back();
+            }
+        }
+
+        bool ok = ReadFile(m_Files[i], buf);
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Ready[i] = {ok, std::move(buf)};
+        }
+        buf = std::vector<uchar>();
+        m_Read.notify_all();
+    }
+}
+
+bool FilePrefetcher::Next(size_t& idx, std::string& name, std::vector<uchar>& data, bool& ok){
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    if(m_NextTaken >= m_Files.size())
+        return false;
+    idx = m_NextTaken++;
+    m_CanRead.notify_all();
+
+    if(!m_Ready.count(idx)){
+        auto start = std::chrono::steady_clock::now();
+        m_Read.wait(lock, [this, idx](){ return m_Ready.count(idx) > 0; });
+        m_Waits++;
+        m_WaitTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    auto file = m_Ready.find(idx);
+    ok = file->second.ok;
+    data.swap(file->second.data);
+    m_Free.push_back(std::move(file->second.data));
+    m_Ready.erase(file);
+    name = m_Files[idx].string();
+    return true;
+}
+
+size_t FilePrefetcher::GetWaits() const{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Waits;
+}
+
+double FilePrefetcher::GetWaitTime() const{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_WaitTime;
+}
+
+size_t FilePrefetcher::GetTaken() const{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_NextTaken;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file FilePrefetcher.h
+ * @brief Class which reads the next files on background threads.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#ifndef FILEPREFETCHER_H
+#define FILEPREFETCHER_H
+
+#include <map>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <filesystem>
+#include <opencv2/core.hpp>
+#include <Object.h>
+
+/**
+ * @brief File prefetcher.
+ * Reader threads read the files ahead of the consumers, at most depth files past the
+ * oldest file not yet taken. Files are handed out in list order and buffers of consumed
+ * files are reused by the readers. Counts how often consumers had to wait for a file.
+ */
+class FilePrefetcher : public giri::Object<FilePrefetcher> {
+public:
+
+    /**
+     * CTor, starts reading immediately.
+     * @param files Files to be read.
+     * @param readers Number of reader threads.
+     * @param depth Maximum number of files read ahead.
+     */
+    FilePrefetcher(std::vector<std::filesystem::path> files, size_t readers, size_t depth);
+
+    /**
+     * DTor, stops the reader threads.
+     */
+    virtual ~FilePrefetcher();
+
+    /**
+     * Takes the next file, blocks until it was read. Thread safe.
+     * @param idx [out] Index of the file within the list.
+     * @param name [out] File name.
+     * @param data [out] File content, the previous buffer is handed back to the readers.
+     * @param ok [out] false if the file could not be read.
+     * @return false if all files were taken.
+     */
+    bool Next(size_t& idx, std::string& name, std::vector<uchar>& data, bool& ok);
+
+    /**
+     * @return Number of files consumers had to wait for.
+     */
+    size_t GetWaits() const;
+
+    /**
+     * @return Total time consumers waited for files, in seconds.
+     */
+    double GetWaitTime() const;
+
+    /**
+     * @return Number of files taken so far.
+     */
+    size_t GetTaken() const;
+
+    /**
+     * Reads a whole file into the buffer, the buffer capacity is kept.
+     * @param f File to be read.
+     * @param data [out] File content.
+     * @return false if the file is no regular file or could not be read.
+     */
+    static bool ReadFile(const std::filesystem::path& f, std::vector<uchar>& data);
+
+    using SPtr = std::shared_ptr<FilePrefetcher>;
+    using UPtr = std::unique_ptr<FilePrefetcher>;
+    using WPtr = std::weak_ptr<FilePrefetcher>;
+
+private:
+    struct File {
+        bool ok;
+        std::vector<uchar> data;
+    };
+
+    void read();
+
+    std::vector<std::filesystem::path> m_Files;
+    size_t m_Depth;
+    size_t m_NextRead = 0;
+    size_t m_NextTaken = 0;
+    bool m_Stop = false;
+    std::map<size_t, File> m_Ready;
+    std::vector<std::vector<uchar>> m_Free;
+    size_t m_Waits = 0;
+    double m_WaitTime = 0;
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_CanRead;
+    std::condition_variable m_Read;
+    std::vector<std::thread> m_Readers;
+};
+
+#endif // FILEPREFETCHER_H
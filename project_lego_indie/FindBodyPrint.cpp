@@ -16,16 +16,20 @@
 #include "ImgShow.h"
 
 bool FindBodyPrint::DoWork(cv::Mat& pic) {
-    cv::Mat pic_HSV;
-    cv::cvtColor(pic, pic_HSV, cv::COLOR_BGR2HSV);
-    cv::Mat roiCenter = pic_HSV(cv::Rect(pic.cols * 0.38, pic.rows * 0.42, (pic.cols - pic.cols * 0.38) - (pic.cols - pic.cols * 0.62), (pic.rows - pic.rows * 0.42) - (pic.rows - pic.rows * 0.58)));
-    cv::Mat hasBodyPrint;
-    cv::inRange(roiCenter, m_LowerColorBound, m_UpperColorBound, hasBodyPrint);
+    PicContext ctx(pic);
+    return DoWork(pic, ctx);
+}
+
+bool FindBodyPrint::DoWork(cv::Mat& pic, PicContext& ctx) {
+    cv::Rect roiCenter(pic.cols * 0.38, pic.rows * 0.42, (pic.cols - pic.cols * 0.38) - (pic.cols - pic.cols * 0.62), (pic.rows - pic.rows * 0.42) - (pic.rows - pic.rows * 0.58));
 
-    if(m_ShowInfo)
+    if(m_ShowInfo){
+        cv::Mat hasBodyPrint;
+        cv::inRange(ctx.GetHSV()(roiCenter), m_LowerColorBound, m_UpperColorBound, hasBodyPrint);
         ImgShow(hasBodyPrint, "Has body print", ImgShow::grey, false, true);
+    }
 
-    if(cv::countNonZero(hasBodyPrint))
+    if(ctx.CountInRange(roiCenter, m_LowerColorBound, m_UpperColorBound, 1))
         return true;
     return false;
 }
@@ -11,12 +11,158 @@
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/imgcodecs.hpp>
+#include <opencv2/core/hal/intrin.hpp>
 
 #include "FindFigure.h"
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 
 #include "ImgShow.h"
+#include "StageTimer.h"
+
+/**
+ * Multiplies a row of 8 bit values with a float gain and saturates the result back to 8 bit.
+ * @param src Source row.
+ * @param gain Gain per value.
+ * @param dst Destination row.
+ * @param n Number of values (pixels * channels).
+ */
+static void apply_gain(const uchar* src, const float* gain, uchar* dst, int n){
+    int x = 0;
+#if CV_SIMD
+    const int lanes = cv::v_float32::nlanes;
+    for(; x <= n - cv::v_uint8::nlanes; x += cv::v_uint8::nlanes){
+        cv::v_uint16 w0, w1;
+        cv::v_uint32 q0, q1, q2, q3;
+        cv::v_expand(cv::vx_load(src + x), w0, w1);
+        cv::v_expand(w0, q0, q1);
+        cv::v_expand(w1, q2, q3);
+        cv::v_int32 r0 = cv::v_round(cv::v_cvt_f32(cv::v_reinterpret_as_s32(q0)) * cv::vx_load(gain + x));
+        cv::v_int32 r1 = cv::v_round(cv::v_cvt_f32(cv::v_reinterpret_as_s32(q1)) * cv::vx_load(gain + x + lanes));
+        cv::v_int32 r2 = cv::v_round(cv::v_cvt_f32(cv::v_reinterpret_as_s32(q2)) * cv::vx_load(gain + x + 2 * lanes));
+        cv::v_int32 r3 = cv::v_round(cv::v_cvt_f32(cv::v_reinterpret_as_s32(q3)) * cv::vx_load(gain + x + 3 * lanes));
+        cv::v_store(dst + x, cv::v_pack_u(cv::v_pack(r0, r1), cv::v_pack(r2, r3)));
+    }
+    cv::vx_cleanup();
+#endif
+    for(; x < n; x++)
+        dst[x] = cv::saturate_cast<uchar>(src[x] * gain[x]);
+}
+
+/**
+ * Header of the given size and type over the start of a workspace buffer. The buffer only grows,
+ * so buffers sized by the cut out figure are not reallocated for every other figure size.
+ * Unlike a roi of a bigger matrix the header is continuous, filters do not see any pixels around it.
+ * @param buf Workspace buffer.
+ * @param size Size of the header.
+ * @param type Type of the header.
+ * @return Header without reference count, valid until the buffer grows.
+ */
+static cv::Mat reuse(cv::Mat& buf, const cv::Size& size, int type){
+    const size_t bytes = static_cast<size_t>(size.area()) * CV_ELEM_SIZE(type);
+    if(buf.total() * buf.elemSize() < bytes)
+        buf.create(1, static_cast<int>(bytes), CV_8UC1);
+    return cv::Mat(size, type, buf.data);
+}
+
+FindFigure::FindFigure(const cv::Mat& bg, bool inf, shift_mode mode, bool track, int scale) : m_Background(bg),
+    // size dependent parameters are given for full resolution pictures
+    m_crop_x(cvRound(35.0 / scale)), m_crop_y(cvRound(27.0 / scale)),
+    m_min_area(17000 / (scale * scale)), m_empty_scale(std::max(1, 8 / scale)), m_shift_sp(25.0 / scale),
+    m_ShowInfo(inf), m_ShiftMode(mode), m_Tracking(track),
+    m_ErodeKernel(cv::getStructuringElement(cv::MORPH_RECT, cv::Size(std::max(3, (15 / scale) | 1), std::max(3, (15 / scale) | 1)))){
+    CV_Assert(scale >= 1);
+    // brightness correction is pic / bg * 255, the background never changes, so precompute the gain
+    // only the cropped region is ever corrected
+    CV_Assert(bg.type() == CV_8UC3);
+    cv::Mat bgRoi = bg(crop_rect(bg.size()));
+    m_Gain.create(bgRoi.size(), CV_32FC3);
+    for(int y = 0; y < bgRoi.rows; y++){
+        const uchar* b = bgRoi.ptr<uchar>(y);
+        float* g = m_Gain.ptr<float>(y);
+        for(int x = 0; x < bgRoi.cols * 3; x++){
+            // black background pixels: any picture value > 0 saturates, 0 stays 0
+            g[x] = b[x] ? 255.f / b[x] : 255.f * 256.f;
+        }
+    }
+
+    // downscaled background for the empty picture check
+    cv::resize(bgRoi, m_SmallBackground, empty_size(bgRoi.size()), 0, 0, cv::INTER_AREA);
+
+    // vertical derivative kernels of cv::Sobel(dx = 0, dy = 1, ksize = 3)
+    cv::getDerivKernels(m_SobelX, m_SobelY, 0, 1, 3, false, CV_32F);
+
+    // pictures always have the size of the background
+    allocate_workspace(bgRoi.size());
+}
+
+void FindFigure::allocate_workspace(const cv::Size& roi){
+    // buffers sized by the roi
+    m_Work.roi.create(roi, CV_8UC3);
+    m_Work.shifted.create(roi, CV_8UC3);
+    m_Work.grey.create(roi, CV_8UC1);
+    m_Work.erode.create(roi, CV_8UC1);
+    m_Work.erodeMask.create(roi, CV_8UC1);
+    m_Work.thresh.create(roi, CV_8UC1);
+    m_Work.smallFrame.create(m_SmallBackground.size(), CV_8UC3);
+    if(m_Tracking){
+        m_Track.key.create(roi, CV_8UC3);
+        m_Work.diff.create(1, roi.area() * 3, CV_8UC1);
+        m_Work.diffMask.create(1, roi.area() * 3, CV_8UC1);
+    }
+    if(m_ShiftMode == fast){
+        // same rounding as cv::resize with a factor of 0.5
+        const cv::Size half(cvRound(roi.width * 0.5), cvRound(roi.height * 0.5));
+        m_Work.small.create(half, CV_8UC3);
+        m_Work.smallShifted.create(half, CV_8UC3);
+    }
+
+    // the minimum area rectangle of a contour is not larger than its bounding box within the roi,
+    // so the cut out figure never has more pixels than the roi (plus the rounding of its sides)
+    const int cut = (roi.width + 1) * (roi.height + 1);
+    m_Work.rotated.create(1, cut * 3, CV_8UC1);
+    for(cv::Mat* buf : {&m_Work.binCutPic, &m_Work.binCutPicGaussFlt, &m_Work.binCutPicMask, &m_Work.zeroMask,
+                        &m_Work.edges, &m_Work.binEdges, &m_Work.threshEdges})
+        buf->create(1, cut, CV_8UC1);
+    m_Work.houghLines.reserve(1024);
+    m_Work.lines.reserve(1024);
+
+    // buffers of the normalized figure
+    m_Work.figure.create(m_scale_y, m_scale_x, CV_8UC3);
+    m_Work.cutMask.create(m_scale_y, m_scale_x, CV_8UC1);
+}
+
+std::string FindFigure::GetConfig() const{
+    return "crop " + std::to_string(m_crop_x) + "x" + std::to_string(m_crop_y) +
+           " out " + std::to_string(m_scale_x) + "x" + std::to_string(m_scale_y) +
+           " area " + std::to_string(m_min_area) + " empty " + std::to_string(m_empty_scale) + "/" + std::to_string(m_empty_diff) +
+           " erode " + std::to_string(m_ErodeKernel.cols) + " shift " + std::to_string(m_shift_sp) + "/" + std::to_string(static_cast<int>(m_ShiftMode));
+}
+
+cv::Size FindFigure::empty_size(const cv::Size& roi) const{
+    return cv::Size(std::max(1, roi.width / m_empty_scale), std::max(1, roi.height / m_empty_scale));
+}
+
+bool FindFigure::empty_frame(const cv::Mat& pic){
+    StageTimer timer(StageStats::empty_frame);
+    cv::resize(crop(pic), m_Work.smallFrame, m_SmallBackground.size(), 0, 0, cv::INTER_AREA);
+
+    // a figure covers at least m_min_area pixels, at the reduced size at least a quarter
+    // of them has to differ from the background, otherwise nothing can be found later on
+    const int limit = static_cast<int>(m_min_area / (m_empty_scale * m_empty_scale) / 4);
+    int changed = 0;
+    for(int y = 0; y < m_SmallBackground.rows; y++){
+        const uchar* p = m_Work.smallFrame.ptr<uchar>(y);
+        const uchar* b = m_SmallBackground.ptr<uchar>(y);
+        for(int x = 0; x < m_SmallBackground.cols * 3; x += 3){
+            int d = std::max({std::abs(p[x] - b[x]), std::abs(p[x + 1] - b[x + 1]), std::abs(p[x + 2] - b[x + 2])});
+            if(d > m_empty_diff && ++changed >= limit)
+                return false;
+        }
+    }
+    return true;
+}
 
 cv::Mat FindFigure::drawLineP(const std::vector<cv::Vec4i>& lines, const cv::Mat& pic){
     cv::Mat cpy;
@@ -34,17 +180,25 @@ cv::Mat FindFigure::drawLineP(const std::vector<cv::Vec4i>& lines, const cv::Mat
     return cpy;
 }
 
-std::vector<cv::Vec4i> FindFigure::analyzeLines(const cv::Mat & pic){
+const std::vector<cv::Vec4i>& FindFigure::find_lines(const cv::Mat & edges){
+    cv::HoughLinesP(edges, m_Work.houghLines, 1, CV_PI/180, 10, 10, 20);
+    return m_Work.houghLines;
+}
+
+const std::vector<cv::Vec4i>& FindFigure::analyzeLines(const cv::Mat & pic){
+    StageTimer timer(StageStats::analyze_lines);
     // find line in feet or body
-    cv::Mat edges, binEdges, threshEdges;
+    cv::Mat binEdges = reuse(m_Work.binEdges, pic.size(), CV_8UC1);
+    cv::Mat edges = reuse(m_Work.edges, pic.size(), CV_8UC1);
+    cv::Mat threshEdges = reuse(m_Work.threshEdges, pic.size(), CV_8UC1);
     cv::cvtColor(pic, binEdges, cv::COLOR_BGR2GRAY);
-    std::vector<cv::Vec4i> lines; 
-    cv::Sobel(binEdges, edges, CV_8U, 0, 1, 3, 1.0, 1);
+    // same as cv::Sobel(binEdges, edges, CV_8U, 0, 1, 3, 1.0, 1), which creates its kernels on every call
+    cv::sepFilter2D(binEdges, edges, CV_8U, m_SobelX, m_SobelY, cv::Point(-1, -1), 1);
     cv::threshold(edges, threshEdges, 130, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
-    cv::HoughLinesP(threshEdges, lines, 1, CV_PI/180, 10, 10, 20);
 
-    std::vector<cv::Vec4i> ret;
-    for(const auto& line : lines) {
+    std::vector<cv::Vec4i>& ret = m_Work.lines;
+    ret.clear();
+    for(const auto& line : find_lines(threshEdges)) {
         cv::Point pt1, pt2;
         pt1.x = line[0]; pt1.y = line[1];
         pt2.x = line[2]; pt2.y = line[3];
@@ -65,43 +219,60 @@ std::vector<cv::Vec4i> FindFigure::analyzeLines(const cv::Mat & pic){
 }
 
 
-cv::Mat FindFigure::correct_brightness(const cv::Mat& pic){
-    // divide original image with bg for brightness correction
-    cv::Mat tmp1, tmp2;
-    pic.convertTo(tmp1, CV_32FC3); 
-    m_Background.convertTo(tmp2, CV_32FC3); 
-    cv::Mat brightness_corrected = (tmp1) / (tmp2);
-    brightness_corrected.convertTo(brightness_corrected, CV_8UC3, 255);
-    return brightness_corrected;
+cv::Rect FindFigure::crop_rect(const cv::Size& size) const{
+    return cv::Rect(m_crop_x, m_crop_y, size.width - 2 * m_crop_x, size.height - 2 * m_crop_y);
 }
 
-cv::Mat FindFigure::crop(const cv::Mat & brightness_corrected){
-    cv::Mat roi = brightness_corrected(cv::Rect(m_crop_x, m_crop_y, brightness_corrected.cols - 2 * m_crop_x, brightness_corrected.rows - 2 * m_crop_y));
-    roi = roi.clone(); // really get rid of of parts outside roi
-    return roi;
+cv::Mat FindFigure::crop(const cv::Mat & pic){
+    StageTimer timer(StageStats::crop);
+    // only a view, correct_brightness writes the roi into the workspace
+    CV_Assert(pic.size() == m_Background.size());
+    return pic(crop_rect(pic.size()));
+}
+
+cv::Mat FindFigure::correct_brightness(const cv::Mat& roi){
+    StageTimer timer(StageStats::correct_brightness);
+    // divide roi with bg for brightness correction (multiply with precomputed gain)
+    CV_Assert(roi.type() == CV_8UC3 && roi.size() == m_Gain.size());
+    cv::Mat& brightness_corrected = m_Work.roi;
+    brightness_corrected.create(roi.size(), CV_8UC3);
+    for(int y = 0; y < roi.rows; y++)
+        apply_gain(roi.ptr<uchar>(y), m_Gain.ptr<float>(y), brightness_corrected.ptr<uchar>(y), roi.cols * 3);
+    return brightness_corrected;
 }
 
 cv::Mat FindFigure::shift(const cv::Mat & roi){
-    cv::Mat shifted;
-    cv::pyrMeanShiftFiltering(roi, shifted, 25, 45);
+    StageTimer timer(StageStats::shift);
+    cv::Mat& shifted = m_Work.shifted;
+    if(m_ShiftMode == fast){
+        // half the pixels per axis and half the spatial window, the color window stays the same
+        cv::resize(roi, m_Work.small, cv::Size(), 0.5, 0.5, cv::INTER_AREA);
+        cv::pyrMeanShiftFiltering(m_Work.small, m_Work.smallShifted, m_shift_sp * 0.5, 45);
+        cv::resize(m_Work.smallShifted, shifted, roi.size(), 0, 0, cv::INTER_LINEAR);
+        return shifted;
+    }
+    cv::pyrMeanShiftFiltering(roi, shifted, m_shift_sp, 45);
     return shifted;
 }
 
 cv::Mat FindFigure::make_grey(const cv::Mat & shifted){
-    cv::Mat grey;
+    StageTimer timer(StageStats::make_grey);
+    cv::Mat& grey = m_Work.grey;
     cv::cvtColor(shifted, grey, cv::COLOR_BGR2GRAY);
     return grey;
 }
 
 cv::Mat FindFigure::make_erode(const cv::Mat & grey){
-    cv::Mat erode, erode_mask;
-    cv::erode(grey, erode, cv::getStructuringElement(cv::MORPH_RECT, cv::Size(15, 15)));
-    cv::threshold(erode, erode_mask, 180, 255, cv::THRESH_BINARY_INV);
+    StageTimer timer(StageStats::make_erode);
+    cv::Mat& erode_mask = m_Work.erodeMask;
+    cv::erode(grey, m_Work.erode, m_ErodeKernel);
+    cv::threshold(m_Work.erode, erode_mask, 180, 255, cv::THRESH_BINARY_INV);
     return erode_mask;
 }
 
 cv::Mat FindFigure::make_thresh(const cv::Mat & grey, const cv::Mat & erode_mask){
-    cv::Mat thresh;
+    StageTimer timer(StageStats::make_thresh);
+    cv::Mat& thresh = m_Work.thresh;
     cv::threshold(grey, thresh, 230, 255, cv::THRESH_BINARY_INV);
 
     // combine eroding mask + threshhold
@@ -109,12 +280,14 @@ cv::Mat FindFigure::make_thresh(const cv::Mat & grey, const cv::Mat & erode_mask
     return thresh;
 }
 
-std::tuple<std::vector<std::vector<cv::Point>>, std::vector<cv::Vec4i>, std::vector<cv::RotatedRect>> FindFigure::find_contours_ff(const cv::Mat & thresh){
-    std::vector<std::vector<cv::Point>> cnt;
-    std::vector<cv::Vec4i> hier;
+FindFigure::contours FindFigure::find_contours_ff(const cv::Mat & thresh){
+    StageTimer timer(StageStats::find_contours_ff);
+    std::vector<std::vector<cv::Point>>& cnt = m_Work.cnt;
+    std::vector<cv::Vec4i>& hier = m_Work.hier;
     cv::findContours(thresh, cnt, hier, cv::RETR_TREE, cv::CHAIN_APPROX_SIMPLE); // find contours
 
-    std::vector<cv::RotatedRect> rot_rcts; // find min area rect
+    std::vector<cv::RotatedRect>& rot_rcts = m_Work.rotRcts; // find min area rect
+    rot_rcts.clear();
     for( size_t i = 0; i < cnt.size(); i++ )
     {
         // skip if cnt is no parent (->3), 
@@ -123,47 +296,66 @@ std::tuple<std::vector<std::vector<cv::Point>>, std::vector<cv::Vec4i>, std::vec
         
         cv::Rect rct = cv::boundingRect(cnt[i]);
 
-        // only use rectangles with at least 17000 pixels and also filter way too big ones (caused by shadows etc.)
-        if(rct.area() > 17000 && rct.width < thresh.cols * 0.90 && rct.height < thresh.rows * 0.90)
+        // only use rectangles with at least m_min_area pixels and also filter way too big ones (caused by shadows etc.)
+        if(rct.area() > m_min_area && rct.width < thresh.cols * 0.90 && rct.height < thresh.rows * 0.90)
             rot_rcts.push_back(cv::minAreaRect(cnt[i]));
     }
-    return std::make_tuple(cnt,hier,rot_rcts);
+    return contours(cnt, hier, rot_rcts);
 }
 
-std::pair<cv::Point, cv::Point> FindFigure::check_uppermost(cv::Mat& pic, const std::vector<cv::Vec4i> & lines){
+bool FindFigure::check_uppermost(const cv::Mat& pic, const std::vector<cv::Vec4i> & lines){
+    if(lines.empty())
+        return false;
     cv::Point pt1, pt2;
     pt1.x = lines[0][0]; pt1.y = lines[0][1];
     pt2.x = lines[0][2]; pt2.y = lines[0][3];
     size_t len = cv::norm(pt1 - pt2);
-    if(len < 40 &&
-       pt1.y < pic.rows - pic.rows * 0.85 &&
-       pt2.y < pic.rows - pic.rows * 0.85) cv::flip(pic, pic, 0);
-
-    return std::make_pair(pt1,pt2);
+    return len < 40 &&
+           pt1.y < pic.rows - pic.rows * 0.85 &&
+           pt2.y < pic.rows - pic.rows * 0.85;
 }
 
-std::tuple<cv::Point2f, cv::Mat, cv::Mat, cv::Mat> FindFigure::get_rotation_matrix(const cv::RotatedRect & rot_rect, cv::Mat & roi){
-    // rotate found rectangle
-    cv::Mat M, roiPadded, rotated;
-
-    // get the rotation matrix
-    auto center = rot_rect.center;
-    center.x += roi.cols;
-    center.y += roi.rows;
-    M = getRotationMatrix2D(center, rot_rect.angle, 1.0);
-    cv::copyMakeBorder(roi, roiPadded, roi.rows, roi.rows, roi.cols, roi.cols, cv::BORDER_CONSTANT, cv::Scalar(255,255,255));
-
-    return std::make_tuple(center, roiPadded, M, rotated);
+/**
+ * @return Homogeneous version of cv::getRotationMatrix2D(center, angle, 1.0), without allocating a matrix.
+ */
+static cv::Matx33d rotation(const cv::Point2f& center, double angle){
+    angle *= CV_PI / 180;
+    const double alpha = std::cos(angle);
+    const double beta = std::sin(angle);
+    return cv::Matx33d(alpha, beta, (1 - alpha) * center.x - beta * center.y,
+                       -beta, alpha, beta * center.x + (1 - alpha) * center.y,
+                       0, 0, 1);
 }
 
+/**
+ * @return Transformation equal to cv::flip(pic, pic, 0) for a picture with the given number of rows.
+ */
+static cv::Matx33d flip_vertical(int rows){
+    return cv::Matx33d(1, 0, 0,
+                       0, -1, rows - 1,
+                       0, 0, 1);
+}
 
-bool FindFigure::DoWork(cv::Mat& pic){
+cv::Matx33d FindFigure::get_rotation_matrix(const cv::RotatedRect & rot_rect, cv::Size & size){
+    // rotate found rectangle around its center and move the rectangle to the origin,
+    // same result as rotating the padded roi and cutting the rectangle with cv::getRectSubPix
+    size = rot_rect.size;
+    cv::Matx33d T = rotation(rot_rect.center, rot_rect.angle);
+    T(0, 2) += (size.width - 1) * 0.5 - rot_rect.center.x;
+    T(1, 2) += (size.height - 1) * 0.5 - rot_rect.center.y;
+
+    // if the rectangle is aligned horizontally rotate it by 90 degrees (cv::ROTATE_90_CLOCKWISE)
+    if(size.width > size.height){
+        T = cv::Matx33d(0, -1, size.height - 1,
+                        1, 0, 0,
+                        0, 0, 1) * T;
+        std::swap(size.width, size.height);
+    }
+    return T;
+}
 
-    // divide original image with bg for brightness correction
-    auto brightness_corrected = correct_brightness(pic);
 
-    // crop image / create roi (center of image)
-    auto roi = crop(brightness_corrected);
+const std::vector<cv::RotatedRect>& FindFigure::segment(const cv::Mat& roi){
 
     // load the image and perform pyramid mean shift filtering
     // to aid the thresholding step
@@ -180,68 +372,212 @@ bool FindFigure::DoWork(cv::Mat& pic){
 
     // ----- find contours -----
     auto [cnt, hier, rot_rcts] = find_contours_ff(thresh);
+    return rot_rcts;
+}
 
-    // invalid findings (yeah this part could be done more extensively)
-    if(rot_rcts.size() > 1 || rot_rcts.size() < 1)
-        return false;
-
-    cv::RotatedRect rot_rect = rot_rcts[0];
-
-    // rotate found rectangle
-    // get the rotation matrix
-
-    auto [center, roiPadded, M, rotated] = get_rotation_matrix(rot_rect, roi);
-    
-    // perform the affine transformation
-    cv::warpAffine(roiPadded, rotated, M, roiPadded.size(), cv::INTER_CUBIC);
-
-    // crop the resulting image
-    cv::getRectSubPix(rotated, rot_rect.size, center, pic);
-
-    // if the picture is now aligned horizontally rotate it by 90 degrees
-    if(pic.cols > pic.rows)
-        cv::rotate(pic, pic, cv::ROTATE_90_CLOCKWISE);
+FindFigure::Transform FindFigure::get_transform(const cv::RotatedRect& rot_rect){
+    StageTimer timer(StageStats::get_transform);
+    const cv::Mat& roi = m_Work.roi;
+
+    // every following step (cut, rotations, flips, scaling) is composed into one transformation,
+    // so the roi gets resampled only once into the final picture.
+    // the cut out figure is only needed to decide on flips and the angle correction
+    cv::Size cut_size;
+    const cv::Matx33d cut = get_rotation_matrix(rot_rect, cut_size);
+    cv::Matx33d T = cut;
+    cv::Mat rotated = reuse(m_Work.rotated, cut_size, CV_8UC3);
+    {
+        StageTimer cutTimer(StageStats::warp_cut);
+        cv::warpAffine(roi, rotated, cv::Matx23d(T.get_minor<2, 3>(0, 0)), cut_size, cv::INTER_CUBIC, cv::BORDER_CONSTANT, cv::Scalar(255,255,255));
+    }
 
     // now check center of mass, if the figure head points to bottom flip picture 
-    cv::Mat binCutPic, binCutPicGaussFlt, binCutPicMask;
-    cv::cvtColor(pic, binCutPic, cv::COLOR_BGR2GRAY);
+    cv::Mat binCutPic = reuse(m_Work.binCutPic, cut_size, CV_8UC1);
+    cv::Mat binCutPicGaussFlt = reuse(m_Work.binCutPicGaussFlt, cut_size, CV_8UC1);
+    cv::Mat binCutPicMask = reuse(m_Work.binCutPicMask, cut_size, CV_8UC1);
+    cv::Mat zeroMask = reuse(m_Work.zeroMask, cut_size, CV_8UC1);
+    cv::cvtColor(rotated, binCutPic, cv::COLOR_BGR2GRAY);
     // apply unsharp masking to reduce local shadows
     cv::GaussianBlur(binCutPic, binCutPicGaussFlt, cv::Size(5, 5), 1);
     cv::subtract(binCutPic, binCutPicGaussFlt, binCutPicMask);
     cv::addWeighted(binCutPic, 1, binCutPicMask, 2, 0, binCutPic);
-    cv::bitwise_not(binCutPic, binCutPic, binCutPic == 0);
+    cv::compare(binCutPic, 0, zeroMask, cv::CMP_EQ);
+    cv::bitwise_not(binCutPic, binCutPic, zeroMask);
     cv::threshold(binCutPic, binCutPic, 200, 255, cv::THRESH_BINARY_INV);
     cv::Moments mu = cv::moments(binCutPic, true);
-    if((mu.m01 / mu.m00) < pic.rows / 2)
-        cv::flip(pic, pic, 0);
+    if((mu.m01 / mu.m00) < rotated.rows / 2){
+        cv::flip(rotated, rotated, 0);
+        T = flip_vertical(rotated.rows) * T;
+    }
     
-    std::vector<cv::Vec4i> lines = analyzeLines(pic);
-
     // check if uppermost line is within a certain threshhold to the image border and smaller than 30px
     // if yes the figure misses one foot and is upsidedown, so flip
-    
-    auto [pt1, pt2] = check_uppermost(pic, lines);
+    if(check_uppermost(rotated, analyzeLines(rotated))){
+        cv::flip(rotated, rotated, 0);
+        T = flip_vertical(rotated.rows) * T;
+    }
     
     // adjust figure angle
-    lines = analyzeLines(pic);
-    pt1.x = lines[lines.size()-1][0]; pt1.y = lines[lines.size()-1][1];
-    pt2.x = lines[lines.size()-1][2]; pt2.y = lines[lines.size()-1][3];
-    double angle = CV_PI - std::atan2(pt1.y - pt2.y, pt1.x - pt2.x);
-    angle = angle * -180 / CV_PI;
-    
-    // get the rotation matrix
-    cv::Mat picRot;
-    picRot = getRotationMatrix2D(cv::Point2f(pic.cols/2, pic.rows/2), angle, 1.0);
-    cv::warpAffine(pic, pic, picRot, pic.size(), 1, cv::BORDER_CONSTANT, cv::Scalar(255,255,255));
-    cv::resize(pic, pic, cv::Size(m_scale_x, m_scale_y));
+    const std::vector<cv::Vec4i>& lines = analyzeLines(rotated);
+    if(!lines.empty()){
+        cv::Point pt1, pt2;
+        pt1.x = lines[lines.size()-1][0]; pt1.y = lines[lines.size()-1][1];
+        pt2.x = lines[lines.size()-1][2]; pt2.y = lines[lines.size()-1][3];
+        double angle = CV_PI - std::atan2(pt1.y - pt2.y, pt1.x - pt2.x);
+        angle = angle * -180 / CV_PI;
+        T = rotation(cv::Point2f(rotated.cols/2, rotated.rows/2), angle) * T;
+    }
+
+    // scale to the output size (same pixel center mapping as cv::resize)
+    double sx = static_cast<double>(m_scale_x) / rotated.cols;
+    double sy = static_cast<double>(m_scale_y) / rotated.rows;
+    T = cv::Matx33d(sx, 0, 0.5 * sx - 0.5,
+                    0, sy, 0.5 * sy - 0.5,
+                    0, 0, 1) * T;
+
+    // the angle correction must not show roi pixels outside the cut, so keep the outline of the cut
+    Transform res{T, {}};
+    const cv::Matx33d O = T * cut.inv();
+    const cv::Point2d corners[4] = {{-0.5, -0.5}, {cut_size.width - 0.5, -0.5},
+                                    {cut_size.width - 0.5, cut_size.height - 0.5}, {-0.5, cut_size.height - 0.5}};
+    for(int i = 0; i < 4; i++){
+        res.cut[i].x = static_cast<float>(O(0, 0) * corners[i].x + O(0, 1) * corners[i].y + O(0, 2));
+        res.cut[i].y = static_cast<float>(O(1, 0) * corners[i].x + O(1, 1) * corners[i].y + O(1, 2));
+    }
 
     if(m_ShowInfo){
         ImgShow a(roi, "Brightness corrected ROI", ImgShow::rgb, false);
-        ImgShow b(shifted, "Pyramid mean shifted", ImgShow::rgb, false);
-        ImgShow c(thresh, "Contour threshhold", ImgShow::grey, false);
+        ImgShow b(m_Work.shifted, "Pyramid mean shifted", ImgShow::rgb, false);
+        ImgShow c(m_Work.thresh, "Contour threshhold", ImgShow::grey, false);
         ImgShow d(rotated, "Cut & rotated contour", ImgShow::rgb, false);
-        ImgShow(drawLineP(lines, pic), "Rotetad pic with original lines", ImgShow::rgb, false, true);
+        ImgShow(drawLineP(lines, rotated), "Rotetad pic with original lines", ImgShow::rgb, false, true);
+    }
+    return res;
+}
+
+void FindFigure::normalize(const Transform& T, cv::Mat& figure){
+    StageTimer timer(StageStats::normalize);
+    // single warp from the roi into the final picture, bilinear keeps the template scores
+    // of the feature finders close to the former chain of bilinear steps, cubic sharpens the face
+    cv::warpAffine(m_Work.roi, figure, cv::Matx23d(T.T.get_minor<2, 3>(0, 0)), cv::Size(m_scale_x, m_scale_y), cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar(255,255,255));
+
+    // white outside the cut, like the angle correction of the cut out figure did
+    cv::Point cut[4];
+    for(int i = 0; i < 4; i++)
+        cut[i] = cv::Point(cvRound(T.cut[i].x * 16), cvRound(T.cut[i].y * 16));
+    m_Work.cutMask.create(figure.size(), CV_8UC1);
+    m_Work.cutMask.setTo(255);
+    cv::fillConvexPoly(m_Work.cutMask, cut, 4, cv::Scalar(0), cv::LINE_8, 4);
+    figure.setTo(cv::Scalar(255,255,255), m_Work.cutMask);
+}
+
+bool FindFigure::unchanged(const cv::Mat& roi){
+    StageTimer timer(StageStats::track_check);
+    if(!m_Track.valid)
+        return false;
+
+    // compare with the picture the transformation was computed on, so slow movements add up
+    // channel values which differ more than m_track_diff count as changed
+    cv::Mat diff = reuse(m_Work.diff, m_Track.box.size(), CV_8UC3);
+    cv::Mat diffMask = reuse(m_Work.diffMask, cv::Size(m_Track.box.width * 3, m_Track.box.height), CV_8UC1);
+    cv::absdiff(roi(m_Track.box), m_Track.key(m_Track.box), diff);
+    cv::threshold(diff.reshape(1), diffMask, m_track_diff, 255, cv::THRESH_BINARY);
+    return cv::countNonZero(diffMask) <= m_Track.box.area() * 3 * m_track_ratio;
+}
+
+bool FindFigure::DoWork(cv::Mat& pic){
+
+    // only background, skip segmentation
+    if(empty_frame(pic)){
+        m_Track.valid = false;
+        return false;
+    }
+
+    // crop image / create roi (center of image), pixels outside the roi are never touched
+    // then divide roi with bg for brightness correction
+    auto roi = correct_brightness(crop(pic));
+
+    if(m_Tracking){
+        // figure did not move, only the final warp is needed
+        if(unchanged(roi)){
+            normalize(m_Track.T, m_Work.figure);
+            pic = m_Work.figure;
+            return true;
+        }
+        m_Track.valid = false;
+    }
+
+    const auto& rot_rcts = segment(roi);
+
+    // invalid findings (yeah this part could be done more extensively)
+    if(rot_rcts.size() > 1 || rot_rcts.size() < 1)
+        return false;
+
+    Transform T = get_transform(rot_rcts[0]);
+    if(m_Tracking){
+        // watch the bounding box of the figure plus a margin, so moving edges are noticed
+        roi.copyTo(m_Track.key);
+        cv::Rect box = rot_rcts[0].boundingRect();
+        box.x -= m_track_margin;
+        box.y -= m_track_margin;
+        box.width += 2 * m_track_margin;
+        box.height += 2 * m_track_margin;
+        m_Track.box = box & cv::Rect(0, 0, roi.cols, roi.rows);
+        m_Track.T = T;
+        m_Track.valid = !m_Track.box.empty();
     }
 
+    // the picture shares the workspace buffer
+    normalize(T, m_Work.figure);
+    pic = m_Work.figure;
+    return true;
+}
+
+bool FindFigure::Locate(const cv::Mat& pic, cv::RotatedRect& rect){
+    if(empty_frame(pic))
+        return false;
+
+    const auto& rot_rcts = segment(correct_brightness(crop(pic)));
+    if(rot_rcts.size() != 1)
+        return false;
+
+    rect = rot_rcts[0];
+    rect.center.x += m_crop_x;
+    rect.center.y += m_crop_y;
+    return true;
+}
+
+bool FindFigure::Normalize(cv::Mat& pic, const cv::RotatedRect& rect){
+    auto roi = correct_brightness(crop(pic));
+
+    // the rectangle has to lie within the roi, otherwise the location does not belong to this picture
+    cv::RotatedRect rot_rect = rect;
+    rot_rect.center.x -= m_crop_x;
+    rot_rect.center.y -= m_crop_y;
+    if(!cv::Rect(0, 0, roi.cols, roi.rows).contains(rot_rect.center))
+        return false;
+
+    normalize(get_transform(rot_rect), m_Work.figure);
+    pic = m_Work.figure;
     return true;
-}
\ No newline at end of file
+}
+
+size_t FindFigure::FindAll(const cv::Mat& pic, std::vector<Figure>& figures){
+    if(empty_frame(pic)){
+        figures.clear();
+        return 0;
+    }
+    const auto& rot_rcts = segment(correct_brightness(crop(pic)));
+
+    // keep the buffers of previous calls
+    figures.resize(rot_rcts.size());
+    for(size_t i = 0; i < rot_rcts.size(); i++){
+        normalize(get_transform(rot_rcts[i]), figures[i].pic);
+
+        // rectangles are found within the roi, report them in picture coordinates
+        figures[i].location = rot_rcts[i];
+        figures[i].location.center.x += m_crop_x;
+        figures[i].location.center.y += m_crop_y;
+    }
+    return figures.size();
+}
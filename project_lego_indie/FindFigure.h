@@ -24,32 +24,130 @@
  */
 class FindFigure : public IPicWorker {
 protected:
-    virtual cv::Mat correct_brightness(const cv::Mat& pic);
-    virtual cv::Mat crop(const cv::Mat & brightness_corrected);
+    using contours = std::tuple<const std::vector<std::vector<cv::Point>>&, const std::vector<cv::Vec4i>&, const std::vector<cv::RotatedRect>&>;
+
+    // stages write into the workspace and return views of it, results are valid until the next picture
+    virtual cv::Mat crop(const cv::Mat & pic);
+    virtual cv::Mat correct_brightness(const cv::Mat& roi);
     virtual cv::Mat shift(const cv::Mat & roi);
     virtual cv::Mat make_grey(const cv::Mat & shifted);
     virtual cv::Mat make_erode(const cv::Mat & grey);
     virtual cv::Mat make_thresh(const cv::Mat & grey, const cv::Mat & erode_mask);
-    virtual std::tuple<std::vector<std::vector<cv::Point>>, std::vector<cv::Vec4i>, std::vector<cv::RotatedRect>> find_contours_ff(const cv::Mat & thresh);
-    virtual std::pair<cv::Point, cv::Point> check_uppermost(cv::Mat& pic, const std::vector<cv::Vec4i> & lines);
-    virtual std::tuple<cv::Point2f, cv::Mat, cv::Mat, cv::Mat> get_rotation_matrix(const cv::RotatedRect & rot_rect, cv::Mat & roi);
-    virtual std::vector<cv::Vec4i> analyzeLines(const cv::Mat & pic);
+    virtual contours find_contours_ff(const cv::Mat & thresh);
+    virtual bool check_uppermost(const cv::Mat& pic, const std::vector<cv::Vec4i> & lines);
+    virtual cv::Matx33d get_rotation_matrix(const cv::RotatedRect & rot_rect, cv::Size & size);
+    virtual const std::vector<cv::Vec4i>& analyzeLines(const cv::Mat & pic);
+    virtual const std::vector<cv::Vec4i>& find_lines(const cv::Mat & edges);
+
+    /**
+     * Runs all stages after the brightness correction up to the contour search.
+     * @param roi Brightness corrected roi of the picture to be searched.
+     * @return Rotated rectangles of all figure candidates within the roi.
+     */
+    const std::vector<cv::RotatedRect>& segment(const cv::Mat& roi);
+
+    /**
+     * @brief Transformation of one candidate into the normalized figure.
+     */
+    struct Transform {
+        cv::Matx33d T;      // transformation from the brightness corrected roi to the normalized figure
+        cv::Point2f cut[4]; // corners of the cut out rectangle within the normalized figure
+    };
+
+    /**
+     * Composes cut, rotations, flips and scaling of one candidate into a single transformation.
+     * @param rot_rect Candidate found by segment().
+     * @return Transformation from the brightness corrected roi to the normalized figure.
+     */
+    Transform get_transform(const cv::RotatedRect& rot_rect);
+
+    /**
+     * Warps the brightness corrected roi into the normalized figure, pixels outside the cut out
+     * rectangle are white.
+     * @param T Transformation returned by get_transform().
+     * @param figure [out] Cut out and horizantally rotated figure.
+     */
+    void normalize(const Transform& T, cv::Mat& figure);
+
+    /**
+     * Checks whether the tracked figure stayed in place.
+     * @param roi Brightness corrected roi of the current picture.
+     * @return true if the last transformation can be reused.
+     */
+    bool unchanged(const cv::Mat& roi);
+
+    /**
+     * Cheap check on a downscaled picture, done before any segmentation.
+     * @param pic Picture to be searched.
+     * @return true if the picture does not differ enough from the background to contain a figure.
+     */
+    bool empty_frame(const cv::Mat& pic);
 public:
 
+    /**
+     * Segmentation modes of the pyramid mean shift stage.
+     */
+    enum shift_mode {
+        precise = 0, // mean shift on the full resolution roi
+        fast = 1     // mean shift on a half resolution roi, upsampled afterwards (a quarter of the pixels)
+    };
+
+    /**
+     * @brief One normalized figure of a picture.
+     */
+    struct Figure {
+        cv::Mat pic;              // cut out and horizantally rotated figure
+        cv::RotatedRect location; // figure location within the source picture
+    };
+
     /**
      * CTor
      * @param bg Background picture to be used for brightness adjustment.
      * @param inf if true blocking window showing a graphical result of this worker will be displayed.
+     * @param mode Segmentation mode of the mean shift stage.
+     * @param track if true the transformation of the last figure is reused as long as the figure does not move (for video input).
+     * @param scale Pictures (and bg) are downscaled by this factor, size dependent parameters are adjusted accordingly.
      */
-    FindFigure(const cv::Mat& bg, bool inf = false) : m_Background(bg), m_ShowInfo(inf){};
+    FindFigure(const cv::Mat& bg, bool inf = false, shift_mode mode = precise, bool track = false, int scale = 1);
 
     /**
      * Tries to find a lego figure on the picture.
      * @param pic [in/out] Tries to find any lego figure. Outputs cut out and horizantally rotated figure.
+     *            The output shares its buffer with this worker and stays valid until the next call.
      * @return true if any figure was found, false otherwise.
      */
     virtual bool DoWork(cv::Mat& pic) override;
+    using IPicWorker::DoWork;
+
+    /**
+     * Finds and normalizes every lego figure on the picture.
+     * @param pic Picture to be searched.
+     * @param figures [out] Found figures. Buffers of previously returned figures are reused.
+     * @return Number of found figures.
+     */
+    size_t FindAll(const cv::Mat& pic, std::vector<Figure>& figures);
 
+    /**
+     * Searches the figure without normalizing it, meant for downscaled previews.
+     * @param pic Picture to be searched.
+     * @param rect [out] Figure location within the picture.
+     * @return true if exactly one figure was found.
+     */
+    bool Locate(const cv::Mat& pic, cv::RotatedRect& rect);
+
+    /**
+     * Normalizes a figure found by Locate(), skips the segmentation.
+     * @param pic [in/out] Picture containing the figure. Outputs cut out and horizantally rotated figure.
+     * @param rect Figure location within the picture.
+     * @return false if the location does not lie within the searched region.
+     */
+    bool Normalize(cv::Mat& pic, const cv::RotatedRect& rect);
+
+
+    /**
+     * @return Parameters which influence the found figures, for the result cache.
+     */
+    std::string GetConfig() const;
 
     virtual std::string GetName() override{
          return "Lego figure";
@@ -61,13 +159,57 @@ public:
 
 private:
     cv::Mat m_Background;
-    const size_t m_crop_x = 35;
-    const size_t m_crop_y = 27;
+    cv::Mat m_Gain; // 255 / m_Background within the crop region, precomputed for brightness correction
+    cv::Mat m_SmallBackground; // downscaled crop region of m_Background for the empty picture check
+    const size_t m_crop_x;         // 35 at full resolution
+    const size_t m_crop_y;         // 27 at full resolution
     const size_t m_scale_x = 124;
     const size_t m_scale_y = 200;
+    const int m_min_area;          // minimum bounding box area of a figure within the roi, 17000 at full resolution
+    const int m_empty_scale;       // downscale factor of the empty picture check, 8 at full resolution
+    const double m_shift_sp;       // spatial window of the mean shift, 25 at full resolution
+    const int m_empty_diff = 40;   // channel difference to the background counted as changed
+    const int m_track_margin = 8;      // pixels watched around the bounding box of the tracked figure
+    const double m_track_diff = 30;    // channel difference counted as changed
+    const double m_track_ratio = 0.01; // ratio of changed channel values tolerated within the watched box
 
     bool m_ShowInfo;
+    shift_mode m_ShiftMode;
+    bool m_Tracking;
+    cv::Mat m_ErodeKernel;
+    cv::Mat m_SobelX, m_SobelY; // kernels of the line search
+
+    /**
+     * Buffers of all stages, allocated by the constructor and reused from picture to picture.
+     * Buffers sized by the cut out figure (rotated, binCutPic*, zeroMask, the line search) and by
+     * the tracked box (diff*) are byte buffers which are handed out as headers of the needed size.
+     * OpenCV still allocates its own temporaries, see AllocTest.cpp.
+     */
+    struct Workspace {
+        cv::Mat roi, small, smallShifted, shifted, grey, erode, erodeMask, thresh;
+        std::vector<std::vector<cv::Point>> cnt;
+        std::vector<cv::Vec4i> hier;
+        std::vector<cv::RotatedRect> rotRcts;
+        cv::Mat rotated, binCutPic, binCutPicGaussFlt, binCutPicMask, zeroMask;
+        cv::Mat edges, binEdges, threshEdges;
+        std::vector<cv::Vec4i> houghLines, lines;
+        cv::Mat figure, cutMask;
+        cv::Mat diff, diffMask, smallFrame;
+    } m_Work;
+
+    /**
+     * Last normalized figure, reused by the tracking mode.
+     */
+    struct Track {
+        bool valid = false;
+        Transform T;    // transformation from the roi to the normalized figure
+        cv::Rect box;   // watched region within the roi
+        cv::Mat key;    // brightness corrected roi the transformation was computed on
+    } m_Track;
 
+    void allocate_workspace(const cv::Size& roi);
+    cv::Rect crop_rect(const cv::Size& size) const;
+    cv::Size empty_size(const cv::Size& roi) const;
     cv::Mat drawLineP(const std::vector<cv::Vec4i>& lines, const cv::Mat& pic);
 };
 
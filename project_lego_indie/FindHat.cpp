@@ -15,16 +15,20 @@
 #include "ImgShow.h"
 
 bool FindHat::DoWork(cv::Mat& pic) {
-    cv::Mat pic_HSV;
-    cv::cvtColor(pic, pic_HSV, cv::COLOR_BGR2HSV);
-    cv::Mat roiHat = pic_HSV(cv::Rect(0, 0, pic.cols, pic.rows * 0.2));
-    cv::Mat hasHat;
-    cv::inRange(roiHat, m_LowerColorBound, m_UpperColorBound, hasHat);
+    PicContext ctx(pic);
+    return DoWork(pic, ctx);
+}
+
+bool FindHat::DoWork(cv::Mat& pic, PicContext& ctx) {
+    cv::Rect roiHat(0, 0, pic.cols, pic.rows * 0.2);
 
-    if(m_ShowInfo)
+    if(m_ShowInfo){
+        cv::Mat hasHat;
+        cv::inRange(ctx.GetHSV()(roiHat), m_LowerColorBound, m_UpperColorBound, hasHat);
         ImgShow(hasHat, "Has hat", ImgShow::grey, false, true);
+    }
 
-    if(cv::countNonZero(hasHat) > 500)
+    if(ctx.CountInRange(roiHat, m_LowerColorBound, m_UpperColorBound, 501) > 500)
         return true;
     return false;
 }
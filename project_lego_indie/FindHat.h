@@ -35,6 +35,18 @@ class FindHat: public IPicWorker {
          */
         virtual bool DoWork(cv::Mat& pic) override;
 
+        /**
+         * Tries to find the hat using the HSV plane shared by the context.
+         * @param pic [in] Picture to analyze.
+         * @param ctx Analysis context belonging to pic.
+         * @return true if feature was found, false otherwise.
+         */
+        virtual bool DoWork(cv::Mat& pic, PicContext& ctx) override;
+
+
+        virtual std::vector<ColorRange> GetColorRanges() override{
+            return {{m_LowerColorBound, m_UpperColorBound}};
+        };
 
         virtual std::string GetName() override{
             return "Hat";
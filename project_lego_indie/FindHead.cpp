@@ -16,16 +16,20 @@
 #include "ImgShow.h"
 
 bool FindHead::DoWork(cv::Mat& pic) {
-    cv::Mat pic_HSV;
-    cv::cvtColor(pic, pic_HSV, cv::COLOR_BGR2HSV);
-    cv::Mat roiHead = pic_HSV(cv::Rect(0, 0, pic.cols, pic.rows * 0.3));
-    cv::Mat hasHead;
-    cv::inRange(roiHead, m_LowerColorBound, m_UpperColorBound, hasHead);
+    PicContext ctx(pic);
+    return DoWork(pic, ctx);
+}
 
-    if(m_ShowInfo)
+bool FindHead::DoWork(cv::Mat& pic, PicContext& ctx) {
+    cv::Rect roiHead(0, 0, pic.cols, pic.rows * 0.3);
+
+    if(m_ShowInfo){
+        cv::Mat hasHead;
+        cv::inRange(ctx.GetHSV()(roiHead), m_LowerColorBound, m_UpperColorBound, hasHead);
         ImgShow(hasHead, "Has head", ImgShow::grey, false, true);
+    }
 
-    if(cv::countNonZero(hasHead))
+    if(ctx.CountInRange(roiHead, m_LowerColorBound, m_UpperColorBound, 1))
         return true;
     return false;
 }
\ No newline at end of file
@@ -15,16 +15,20 @@
 #include "ImgShow.h"
 
 bool FindLeftFoot::DoWork(cv::Mat& pic) {
-    cv::Mat pic_HSV;
-    cv::cvtColor(pic, pic_HSV, cv::COLOR_BGR2HSV);
-    cv::Mat roiLeftFoot = pic_HSV(cv::Rect(0, pic.rows * 0.8, pic.cols * 0.4, pic.rows-pic.rows * 0.8));
-    cv::Mat hasLFoot;
-    cv::inRange(roiLeftFoot, m_LowerColorBound, m_UpperColorBound, hasLFoot);
+    PicContext ctx(pic);
+    return DoWork(pic, ctx);
+}
 
-    if(m_ShowInfo)
+bool FindLeftFoot::DoWork(cv::Mat& pic, PicContext& ctx) {
+    cv::Rect roiLeftFoot(0, pic.rows * 0.8, pic.cols * 0.4, pic.rows-pic.rows * 0.8);
+
+    if(m_ShowInfo){
+        cv::Mat hasLFoot;
+        cv::inRange(ctx.GetHSV()(roiLeftFoot), m_LowerColorBound, m_UpperColorBound, hasLFoot);
         ImgShow(hasLFoot, "Has left foot", ImgShow::grey, false, true);
+    }
 
-    if(cv::countNonZero(hasLFoot))
+    if(ctx.CountInRange(roiLeftFoot, m_LowerColorBound, m_UpperColorBound, 1))
         return true;
     return false;
 }
\ No newline at end of file
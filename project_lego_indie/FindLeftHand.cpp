@@ -16,16 +16,20 @@
 #include "ImgShow.h"
 
 bool FindLeftHand::DoWork(cv::Mat& pic) {
-    cv::Mat pic_HSV;
-    cv::cvtColor(pic, pic_HSV, cv::COLOR_BGR2HSV);
-    cv::Mat roiLeftHand = pic_HSV(cv::Rect(0, pic.rows/ 2, pic.cols * 0.3, pic.rows/2));
-    cv::Mat hasLHand;
-    cv::inRange(roiLeftHand, m_LowerColorBound, m_UpperColorBound, hasLHand);
+    PicContext ctx(pic);
+    return DoWork(pic, ctx);
+}
 
-    if(m_ShowInfo)
+bool FindLeftHand::DoWork(cv::Mat& pic, PicContext& ctx) {
+    cv::Rect roiLeftHand(0, pic.rows/ 2, pic.cols * 0.3, pic.rows/2);
+
+    if(m_ShowInfo){
+        cv::Mat hasLHand;
+        cv::inRange(ctx.GetHSV()(roiLeftHand), m_LowerColorBound, m_UpperColorBound, hasLHand);
         ImgShow(hasLHand, "Has left hand", ImgShow::grey, false, true);
+    }
 
-    if(cv::countNonZero(hasLHand))
+    if(ctx.CountInRange(roiLeftHand, m_LowerColorBound, m_UpperColorBound, 1))
         return true;
     return false;
 }
\ No newline at end of file
@@ -15,8 +15,10 @@
 #include <opencv2/imgproc.hpp>
 #include <iostream>
 
+#ifndef HEADLESS
 // FLTK MathGL plotting widget
 #include <mgl2/fltk.h>
+#endif
 
 bool FindRightArm::DoWork(cv::Mat& pic) {
     cv::Mat found;
@@ -27,6 +29,7 @@ bool FindRightArm::DoWork(cv::Mat& pic) {
     cv::minMaxLoc(found, &min, &max);
 
     if(m_ShowInfo){
+#ifndef HEADLESS
         // 3D Plots
         mglFLTK gr = mglFLTK(
             // plotting callback (needed for interactive plots)
@@ -61,6 +64,7 @@ bool FindRightArm::DoWork(cv::Mat& pic) {
         Fl_Widget* widget = (Fl_Widget*)mgl_fltk_widget(gr.Self()); // get the underlaying fltk widget
         Fl_Double_Window* window = ((Fl_Double_Window*)widget->parent()); // get the underlaying fltk window
         window->icon(icon.get()); // now we can do all the wonderful FLTK stuff on the window
+#endif
 
         ImgShow(roi, "Region right arm", ImgShow::rgb, false, true);
     }
@@ -36,6 +36,7 @@ class FindRightArm: public IPicWorker {
          * @return true if feature was found, false otherwise.
          */
         virtual bool DoWork(cv::Mat& pic) override;
+        using IPicWorker::DoWork;
 
 
         virtual std::string GetName() override{
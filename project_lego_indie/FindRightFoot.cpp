@@ -16,16 +16,20 @@
 #include "ImgShow.h"
 
 bool FindRightFoot::DoWork(cv::Mat& pic) {
-    cv::Mat pic_HSV;
-    cv::cvtColor(pic, pic_HSV, cv::COLOR_BGR2HSV);
-    cv::Mat roiRightFoot = pic_HSV(cv::Rect(pic.cols * 0.6, pic.rows * 0.8, pic.cols - pic.cols * 0.6, pic.rows-pic.rows * 0.8));
-    cv::Mat hasRFoot;
-    cv::inRange(roiRightFoot, m_LowerColorBound, m_UpperColorBound, hasRFoot);
+    PicContext ctx(pic);
+    return DoWork(pic, ctx);
+}
 
-    if(m_ShowInfo)
+bool FindRightFoot::DoWork(cv::Mat& pic, PicContext& ctx) {
+    cv::Rect roiRightFoot(pic.cols * 0.6, pic.rows * 0.8, pic.cols - pic.cols * 0.6, pic.rows-pic.rows * 0.8);
+
+    if(m_ShowInfo){
+        cv::Mat hasRFoot;
+        cv::inRange(ctx.GetHSV()(roiRightFoot), m_LowerColorBound, m_UpperColorBound, hasRFoot);
         ImgShow(hasRFoot, "Has right foot", ImgShow::grey, false, true);
+    }
 
-    if(cv::countNonZero(hasRFoot))
+    if(ctx.CountInRange(roiRightFoot, m_LowerColorBound, m_UpperColorBound, 1))
         return true;
     return false;
 }
\ No newline at end of file
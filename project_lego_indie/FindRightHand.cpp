@@ -16,16 +16,20 @@
 #include "ImgShow.h"
 
 bool FindRightHand::DoWork(cv::Mat& pic) {
-    cv::Mat pic_HSV;
-    cv::cvtColor(pic, pic_HSV, cv::COLOR_BGR2HSV);
-    cv::Mat roiRightHand = pic_HSV(cv::Rect(pic.cols - pic.cols * 0.3, pic.rows/ 2, pic.cols * 0.3, pic.rows/2));
-    cv::Mat hasRHand;
-    cv::inRange(roiRightHand, m_LowerColorBound, m_UpperColorBound, hasRHand);
-    
-    if(m_ShowInfo)
+    PicContext ctx(pic);
+    return DoWork(pic, ctx);
+}
+
+bool FindRightHand::DoWork(cv::Mat& pic, PicContext& ctx) {
+    cv::Rect roiRightHand(pic.cols - pic.cols * 0.3, pic.rows/ 2, pic.cols * 0.3, pic.rows/2);
+
+    if(m_ShowInfo){
+        cv::Mat hasRHand;
+        cv::inRange(ctx.GetHSV()(roiRightHand), m_LowerColorBound, m_UpperColorBound, hasRHand);
         ImgShow(hasRHand, "Has right hand", ImgShow::grey, false, true);
+    }
 
-    if(cv::countNonZero(hasRHand))
+    if(ctx.CountInRange(roiRightHand, m_LowerColorBound, m_UpperColorBound, 1))
         return true;
     return false;
 }
\ No newline at end of file
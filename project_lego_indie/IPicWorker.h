@@ -12,9 +12,12 @@
 #define I_PICWORKER_H
 
 #include <string>
+#include <vector>
 #include <opencv2/core.hpp>
 #include <Object.h>
 
+#include "PicContext.h"
+
 /**
  * @brief Interface which describes objects which will perform actions on a given picture.
  */
@@ -28,6 +31,24 @@ class IPicWorker : public giri::Object<IPicWorker> {
      */
     virtual bool DoWork(cv::Mat& pic) = 0;
 
+    /**
+     * Work function using a context shared by all workers analyzing the same picture.
+     * Workers which do not profit from the shared context simply use DoWork(pic).
+     * @param pic Picture to be processed. (may be in/out)
+     * @param ctx Analysis context belonging to pic.
+     * @return true if feature was detected, false otherwise.
+     */
+    virtual bool DoWork(cv::Mat& pic, PicContext& /*ctx*/){
+        return DoWork(pic);
+    }
+
+    /**
+     * @return HSV color ranges this worker searches for, used to build the color classifier shared by all workers.
+     */
+    virtual std::vector<ColorRange> GetColorRanges(){
+        return {};
+    }
+
     /**
      * @return Name of this feature.
      */
@@ -12,6 +12,8 @@
 #ifndef IMGSHOW_H
 #define IMGSHOW_H
 
+#ifndef HEADLESS
+
 // FLTK
 #include <FL/Fl.H>
 #include <FL/Fl_Double_Window.H>
@@ -92,4 +94,28 @@ private:
     cv::Mat m_ImgRGB;
 };
 
-#endif // IMGSHOW_H
\ No newline at end of file
+#else // HEADLESS
+
+#include <string>
+#include <opencv2/core.hpp>
+
+/**
+ * Headless builds have no windows, pictures to be shown are dropped.
+ */
+class ImgShow {
+public:
+
+    enum fl_imgtype{
+        grey =  1,
+        greya = 2,
+        rgb =   3,
+        rgba =  4
+    };
+
+    ImgShow(const cv::Mat&, const std::string&, const ImgShow::fl_imgtype&, bool = false, bool = false){}
+    virtual ~ImgShow() = default;
+};
+
+#endif // HEADLESS
+
+#endif // IMGSHOW_H
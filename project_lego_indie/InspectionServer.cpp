@@ -0,0 +1,222 @@
+/**
+ * @file InspectionServer.cpp
+ * @brief Class which serves inspection requests of local clients over a unix domain socket.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#include "InspectionServer.h"
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+#include <map>
+#include <csignal>
+#include <iostream>
+#include <algorithm>
+
+namespace asio = boost::asio;
+using local = asio::local::stream_protocol;
+
+/**
+ * @brief One client connection.
+ * Lives as long as it is read from, written to or has requests queued. All members are only
+ * touched by the thread running the io context.
+ */
+class InspectionServer::Session : public std::enable_shared_from_this<InspectionServer::Session> {
+public:
+    Session(InspectionServer& server, local::socket socket) :
+        m_Server(server), m_Socket(std::move(socket)) {}
+
+    void Start(){
+        readHeader();
+    }
+
+    /**
+     * Queues the request read last and goes on reading, never blocks.
+     * @return false if the queue is full, the session waits for the next try then.
+     */
+    bool Resume(){
+        m_Pending.session = shared_from_this();
+        if(!m_Server.m_Jobs.TryPush(m_Pending)){
+            m_Pending.session.reset();
+            return false;
+        }
+        m_Pending = Job();
+        readHeader();
+        return true;
+    }
+
+    /**
+     * Queues the record of a finished request, records are sent in request order.
+     */
+    void Complete(uint32_t idx, std::string rec){
+        m_Done[idx] = std::move(rec);
+        for(auto it = m_Done.find(m_NextOut); it != m_Done.end(); it = m_Done.find(++m_NextOut)){
+            m_Out += it->second;
+            m_Done.erase(it);
+        }
+        if(m_Writing.empty() && !m_Out.empty())
+            write();
+    }
+
+private:
+    void readHeader(){
+        auto self = shared_from_this();
+        asio::async_read(m_Socket, asio::buffer(&m_Req, sizeof(m_Req)), [this, self](const boost::system::error_code& ec, size_t){
+            if(ec)
+                return;
+            if(!checkRequest(m_Req)){
+                std::cerr << "Invalid request, client dropped" << std::endl;
+                return;
+            }
+            m_Payload.resize(m_Req.length);
+            readPayload();
+        });
+    }
+
+    void readPayload(){
+        auto self = shared_from_this();
+        asio::async_read(m_Socket, asio::buffer(m_Payload), [this, self](const boost::system::error_code& ec, size_t){
+            if(ec)
+                return;
+            // the session holds itself only through the waiting list, not through its own job
+            m_Pending = {nullptr, m_NextIdx++, m_Req, std::move(m_Payload)};
+            m_Payload = std::vector<uchar>();
+            // while the workers are behind only this client is throttled, waiting clients go first
+            if(!m_Server.m_Waiting.empty() || !Resume())
+                m_Server.m_Waiting.push_back(self);
+        });
+    }
+
+    void write(){
+        auto self = shared_from_this();
+        m_Writing.swap(m_Out);
+        asio::async_write(m_Socket, asio::buffer(m_Writing), [this, self](const boost::system::error_code& ec, size_t){
+            m_Writing.clear();
+            if(ec){
+                // client is gone, results of its remaining requests are dropped
+                m_Out.clear();
+                m_Socket.close();
+                return;
+            }
+            if(!m_Out.empty())
+                write();
+        });
+    }
+
+    InspectionServer& m_Server;
+    local::socket m_Socket;
+    StreamRequest m_Req;
+    std::vector<uchar> m_Payload;
+    Job m_Pending;          // request read last, waits here while the queue is full
+    uint32_t m_NextIdx = 0; // index of the next request read
+    uint32_t m_NextOut = 0; // index of the next record to be sent
+    std::map<uint32_t, std::string> m_Done;
+    std::string m_Out;      // records waiting for the running write
+    std::string m_Writing;  // records of the running write
+};
+
+InspectionServer::InspectionServer(const std::filesystem::path& socket, size_t threads, std::function<Inspector::UPtr()> makeInspector,
+                                   Inspect inspect, const cv::Size& frameSize) :
+    m_Path(socket),
+    m_Threads(std::max<size_t>(threads, 1)),
+    m_MakeInspector(std::move(makeInspector)),
+    m_Inspect(std::move(inspect)),
+    m_FrameSize(frameSize),
+    m_Acceptor(m_Io),
+    m_Signals(m_Io, SIGINT, SIGTERM),
+    m_Jobs(4 * m_Threads)
+{
+    // a socket left behind by a server which is gone is replaced, anything else makes bind fail
+    std::error_code fsEc;
+    if(std::filesystem::is_socket(m_Path, fsEc)){
+        local::socket probe(m_Io);
+        boost::system::error_code probeEc;
+        probe.connect(local::endpoint(m_Path.string()), probeEc);
+        if(probeEc)
+            std::filesystem::remove(m_Path, fsEc);
+    }
+
+    boost::system::error_code ec;
+    local::endpoint ep(m_Path.string());
+    m_Acceptor.open(ep.protocol(), ec);
+    if(!ec)
+        m_Acceptor.bind(ep, ec);
+    if(!ec)
+        m_Acceptor.listen(asio::socket_base::max_listen_connections, ec);
+    if(ec)
+        m_Acceptor.close(ec);
+}
+
+InspectionServer::~InspectionServer(){
+    m_Jobs.Close();
+    for(auto& w : m_Workers)
+        w.join();
+    if(m_Acceptor.is_open()){
+        std::error_code ec;
+        std::filesystem::remove(m_Path, ec);
+    }
+}
+
+bool InspectionServer::IsOpened() const{
+    return m_Acceptor.is_open();
+}
+
+void InspectionServer::Run(){
+    for(size_t i = m_Workers.size(); i < m_Threads; i++)
+        m_Workers.emplace_back(&InspectionServer::work, this);
+
+    m_Signals.async_wait([this](const boost::system::error_code&, int){
+        m_Io.stop();
+    });
+    accept();
+    m_Io.run();
+}
+
+void InspectionServer::accept(){
+    m_Acceptor.async_accept([this](const boost::system::error_code& ec, local::socket socket){
+        if(!ec)
+            std::make_shared<Session>(*this, std::move(socket))->Start();
+        if(m_Acceptor.is_open())
+            accept();
+    });
+}
+
+void InspectionServer::resume(){
+    // oldest first, a session which still does not fit keeps its place
+    while(!m_Waiting.empty() && m_Waiting.front()->Resume())
+        m_Waiting.pop_front();
+}
+
+void InspectionServer::work(){
+    auto inspector = m_MakeInspector();
+    SourcePic src;
+    Job job;
+    while(m_Jobs.Pop(job)){
+        src.idx = job.idx;
+        src.name = "request #" + std::to_string(job.idx);
+        src.buffer.swap(job.payload);
+        std::string rec;
+        try{
+            fromRequest(job.req, src, m_FrameSize);
+            rec = m_Inspect(*inspector, src);
+        }
+        catch(const std::exception& e){
+            // one bad request must not take down the server
+            std::cerr << "Request failed: " << src.name << ": " << e.what() << std::endl;
+            rec.clear();
+            appendFailedRecord(rec, job.idx);
+        }
+
+        // records are sent by the io thread, the queue has room for a waiting session again
+        asio::post(m_Io, [this, session = std::move(job.session), idx = job.idx, rec = std::move(rec)]() mutable {
+            session->Complete(idx, std::move(rec));
+            resume();
+        });
+    }
+}
+
+#endif // BOOST_ASIO_HAS_LOCAL_SOCKETS
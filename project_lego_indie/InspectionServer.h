@@ -0,0 +1,111 @@
+/**
+ * @file InspectionServer.h
+ * @brief Class which serves inspection requests of local clients over a unix domain socket.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#ifndef INSPECTIONSERVER_H
+#define INSPECTIONSERVER_H
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <functional>
+#include <filesystem>
+#include <boost/asio.hpp>
+#include <opencv2/core.hpp>
+#include <Object.h>
+
+#include "Inspector.h"
+#include "SourcePic.h"
+#include "StreamProtocol.h"
+#include "BoundedQueue.h"
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+/**
+ * @brief Inspection server.
+ * Clients send requests as described in StreamProtocol.h and receive one result record per
+ * request, in request order of the connection. Requests of all clients go into one queue
+ * served by a pool of workers, every worker owns its own inspector for the lifetime of the
+ * server. Records which are ready together are sent together. While the queue is full, clients
+ * whose next request does not fit are not read from until a worker finished a request.
+ */
+class InspectionServer : public giri::Object<InspectionServer> {
+public:
+
+    /**
+     * Inspects one picture and returns its result record.
+     */
+    using Inspect = std::function<std::string(Inspector& inspector, SourcePic& src)>;
+
+    /**
+     * CTor, starts listening. A socket left behind by a server which is gone gets replaced, any
+     * other existing file (also the socket of a running server) makes listening fail.
+     * @param socket Path of the socket.
+     * @param threads Number of workers.
+     * @param makeInspector Factory creating one inspector per worker.
+     * @param inspect Inspects one picture, called by the workers.
+     * @param frameSize Size raw frames must have.
+     */
+    InspectionServer(const std::filesystem::path& socket, size_t threads, std::function<Inspector::UPtr()> makeInspector,
+                     Inspect inspect, const cv::Size& frameSize);
+
+    /**
+     * DTor, removes the socket file.
+     */
+    ~InspectionServer();
+
+    /**
+     * @return true if the socket is listening.
+     */
+    bool IsOpened() const;
+
+    /**
+     * Serves clients until SIGINT or SIGTERM is received.
+     */
+    void Run();
+
+    using SPtr = std::shared_ptr<InspectionServer>;
+    using UPtr = std::unique_ptr<InspectionServer>;
+    using WPtr = std::weak_ptr<InspectionServer>;
+
+private:
+    class Session;
+
+    /**
+     * @brief One request waiting for a worker.
+     */
+    struct Job {
+        std::shared_ptr<Session> session;
+        uint32_t idx;
+        StreamRequest req;
+        std::vector<uchar> payload;
+    };
+
+    void accept();
+    void resume();
+    void work();
+
+    std::filesystem::path m_Path;
+    size_t m_Threads;
+    std::function<Inspector::UPtr()> m_MakeInspector;
+    Inspect m_Inspect;
+    cv::Size m_FrameSize;
+
+    boost::asio::io_context m_Io;
+    boost::asio::local::stream_protocol::acceptor m_Acceptor;
+    boost::asio::signal_set m_Signals;
+    BoundedQueue<Job> m_Jobs;
+    std::deque<std::shared_ptr<Session>> m_Waiting; // sessions whose request did not fit into m_Jobs, io thread only
+    std::vector<std::thread> m_Workers;
+};
+
+#endif // BOOST_ASIO_HAS_LOCAL_SOCKETS
+
+#endif // INSPECTIONSERVER_H
@@ -0,0 +1,183 @@
+/**
+ * @file Inspector.cpp
+ * @brief Class which bundles the figure finder and all feature finders needed to inspect one picture.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#include "Inspector.h"
+
+#include <algorithm>
+#include <opencv2/imgproc.hpp>
+
+#include "FindRightHand.h"
+#include "FindLeftHand.h"
+#include "FindRightFoot.h"
+#include "FindLeftFoot.h"
+#include "FindHead.h"
+#include "FindHat.h"
+#include "FindBodyPrint.h"
+#include "FindFacePrint.h"
+#include "FindLeftArm.h"
+#include "FindRightArm.h"
+#include "StageTimer.h"
+
+/**
+ * Runs one feature finder, timed as the given stage.
+ */
+static bool detect(StageStats::stage_t stage, const IPicWorker::SPtr& worker, cv::Mat& pic, PicContext& ctx){
+    StageTimer timer(stage);
+    return worker->DoWork(pic, ctx);
+}
+
+Inspector::Inspector(const cv::Mat& bg, const cv::Mat& templFace, const cv::Mat& templLarm, const cv::Mat& templRarm, bool inf, FindFigure::shift_mode mode, bool track, int previewScale) :
+    m_TemplFace(templFace),
+    m_TemplLarm(templLarm),
+    m_TemplRarm(templRarm),
+    m_ShowInfo(inf),
+    m_Cutter(std::make_shared<FindFigure>(bg, inf, mode, track)),
+    m_PreviewScale(previewScale)
+{
+    m_Features.push_back(makeFeatures());
+
+    if(m_PreviewScale > 1){
+        cv::Mat smallBg;
+        cv::resize(bg, smallBg, cv::Size((bg.cols + m_PreviewScale - 1) / m_PreviewScale, (bg.rows + m_PreviewScale - 1) / m_PreviewScale), 0, 0, cv::INTER_AREA);
+        m_Locator = std::make_shared<FindFigure>(smallBg, false, mode, false, m_PreviewScale);
+    }
+}
+
+Inspector::Features Inspector::makeFeatures() const{
+    Features f;
+    f.m_HeadFinder = std::make_shared<FindHead>(m_ShowInfo);
+    f.m_HatFinder = std::make_shared<FindHat>(m_ShowInfo);
+    f.m_LeftHandFinder = std::make_shared<FindLeftHand>(m_ShowInfo);
+    f.m_RightHandFinder = std::make_shared<FindRightHand>(m_ShowInfo);
+    f.m_RightFootFinder = std::make_shared<FindRightFoot>(m_ShowInfo);
+    f.m_LeftFootFinder = std::make_shared<FindLeftFoot>(m_ShowInfo);
+    f.m_BodyPrintFinder = std::make_shared<FindBodyPrint>(m_ShowInfo);
+    f.m_FacePrintFinder = std::make_shared<FindFacePrint>(m_TemplFace, m_ShowInfo);
+    f.m_LeftArmFinder = std::make_shared<FindLeftArm>(m_TemplLarm, m_ShowInfo);
+    f.m_RightArmFinder = std::make_shared<FindRightArm>(m_TemplRarm, m_ShowInfo);
+
+    // one color classifier for the color ranges of all feature finders
+    std::vector<ColorRange> ranges;
+    for(const auto& worker : {f.m_HeadFinder, f.m_HatFinder, f.m_LeftHandFinder, f.m_RightHandFinder, f.m_RightFootFinder,
+                              f.m_LeftFootFinder, f.m_BodyPrintFinder, f.m_FacePrintFinder, f.m_LeftArmFinder, f.m_RightArmFinder}){
+        auto workerRanges = worker->GetColorRanges();
+        ranges.insert(ranges.end(), workerRanges.begin(), workerRanges.end());
+    }
+    f.m_Context = PicContext(ColorClassifier::Create(ranges));
+    return f;
+}
+
+std::string Inspector::GetConfig() const{
+    std::string config = "figure " + m_Cutter->GetConfig();
+    if(m_Locator)
+        config += " preview " + m_Locator->GetConfig();
+    const Features& f = m_Features[0];
+    for(const auto& worker : {f.m_HeadFinder, f.m_HatFinder, f.m_LeftHandFinder, f.m_RightHandFinder, f.m_RightFootFinder,
+                              f.m_LeftFootFinder, f.m_BodyPrintFinder, f.m_FacePrintFinder, f.m_LeftArmFinder, f.m_RightArmFinder}){
+        config += ", " + worker->GetName();
+        for(const auto& range : worker->GetColorRanges()){
+            for(int c = 0; c < 3; c++)
+                config += " " + std::to_string(range.lower[c]) + "-" + std::to_string(range.upper[c]);
+        }
+    }
+    return config;
+}
+
+InspectionResult Inspector::DoWork(cv::Mat& pic){
+    if(!m_Cutter->DoWork(pic))
+        return InspectionResult();
+    return inspect(m_Features[0], pic);
+}
+
+InspectionResult Inspector::DoWork(const cv::Mat& preview, const std::function<cv::Mat()>& decode, cv::Mat& pic){
+    if(!m_Locator){
+        pic = decode();
+        return DoWork(pic);
+    }
+
+    cv::RotatedRect rect;
+    pic = cv::Mat();
+    if(!m_Locator->Locate(preview, rect))
+        return InspectionResult();
+
+    // a preview pixel covers scale x scale full resolution pixels
+    float s = static_cast<float>(m_PreviewScale);
+    rect.center = rect.center * s + cv::Point2f((s - 1) * 0.5f, (s - 1) * 0.5f);
+    rect.size = cv::Size2f(rect.size.width * s, rect.size.height * s);
+
+    pic = decode();
+    if(pic.empty() || !m_Cutter->Normalize(pic, rect)){
+        pic = cv::Mat();
+        return InspectionResult();
+    }
+    return inspect(m_Features[0], pic);
+}
+
+InspectionResult Inspector::CheckFeatures(cv::Mat& figure){
+    return inspect(m_Features[0], figure);
+}
+
+std::vector<FigureInspection> Inspector::DoWorkAll(const cv::Mat& pic, size_t threads){
+    m_Cutter->FindAll(pic, m_Figures);
+
+    std::vector<FigureInspection> ret(m_Figures.size());
+    size_t sets = m_ShowInfo ? 1 : std::max<size_t>(1, std::min(threads, m_Figures.size()));
+    while(m_Features.size() < sets)
+        m_Features.push_back(makeFeatures());
+
+    // every stripe owns one set of feature finders and checks every sets-th figure
+    const int64_t image = StageTrace::GetImage();
+    cv::parallel_for_(cv::Range(0, static_cast<int>(sets)), [&](const cv::Range& r){
+        StageTrace::SetImage(image);
+        for(int s = r.start; s < r.end; s++){
+            for(size_t i = s; i < m_Figures.size(); i += sets){
+                ret[i].location = m_Figures[i].location;
+                ret[i].pic = m_Figures[i].pic.clone();
+                ret[i].result = inspect(m_Features[s], ret[i].pic);
+            }
+        }
+    }, static_cast<double>(sets));
+    return ret;
+}
+
+InspectionResult Inspector::inspect(Features& f, cv::Mat& pic){
+    InspectionResult res;
+    res.figure = true;
+
+    // all feature finders share the derived planes of the normalized figure
+    f.m_Context.Reset(pic);
+
+    if(detect(StageStats::head, f.m_HeadFinder, pic, f.m_Context)){
+        res.head = true;
+        res.hat = detect(StageStats::hat, f.m_HatFinder, pic, f.m_Context);
+        res.facePrint = detect(StageStats::face_print, f.m_FacePrintFinder, pic, f.m_Context);
+    }
+
+    if(detect(StageStats::left_hand, f.m_LeftHandFinder, pic, f.m_Context)){
+        res.leftHand = true;
+        res.leftArm = true;
+    }
+    else{
+        res.leftArm = detect(StageStats::left_arm, f.m_LeftArmFinder, pic, f.m_Context);
+    }
+
+    if(detect(StageStats::right_hand, f.m_RightHandFinder, pic, f.m_Context)){
+        res.rightHand = true;
+        res.rightArm = true;
+    }
+    else{
+        res.rightArm = detect(StageStats::right_arm, f.m_RightArmFinder, pic, f.m_Context);
+    }
+
+    res.leftFoot = detect(StageStats::left_foot, f.m_LeftFootFinder, pic, f.m_Context);
+    res.rightFoot = detect(StageStats::right_foot, f.m_RightFootFinder, pic, f.m_Context);
+    res.bodyPrint = detect(StageStats::body_print, f.m_BodyPrintFinder, pic, f.m_Context);
+    return res;
+}
@@ -0,0 +1,171 @@
+/**
+ * @file Inspector.h
+ * @brief Class which bundles the figure finder and all feature finders needed to inspect one picture.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#ifndef INSPECTOR_H
+#define INSPECTOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <functional>
+#include <opencv2/core.hpp>
+#include <Object.h>
+
+#include "IPicWorker.h"
+#include "FindFigure.h"
+
+/**
+ * @brief Features found on one picture.
+ */
+struct InspectionResult {
+    bool figure = false;
+    bool hat = false;
+    bool head = false;
+    bool leftHand = false;
+    bool rightHand = false;
+    bool leftArm = false;
+    bool rightArm = false;
+    bool leftFoot = false;
+    bool rightFoot = false;
+    bool facePrint = false;
+    bool bodyPrint = false;
+};
+
+/**
+ * @return Features packed into one bit each, in declaration order starting with figure as bit 0.
+ */
+inline uint16_t ToBits(const InspectionResult& res){
+    const bool bits[] = {res.figure, res.hat, res.head, res.leftHand, res.rightHand, res.leftArm,
+                         res.rightArm, res.leftFoot, res.rightFoot, res.facePrint, res.bodyPrint};
+    uint16_t ret = 0;
+    for(size_t i = 0; i < sizeof(bits) / sizeof(bits[0]); i++)
+        ret |= static_cast<uint16_t>(bits[i]) << i;
+    return ret;
+}
+
+/**
+ * @return Features unpacked from the bits created by ToBits().
+ */
+inline InspectionResult FromBits(uint16_t bits){
+    InspectionResult res;
+    bool* features[] = {&res.figure, &res.hat, &res.head, &res.leftHand, &res.rightHand, &res.leftArm,
+                        &res.rightArm, &res.leftFoot, &res.rightFoot, &res.facePrint, &res.bodyPrint};
+    for(size_t i = 0; i < sizeof(features) / sizeof(features[0]); i++)
+        *features[i] = (bits >> i) & 1;
+    return res;
+}
+
+/**
+ * @brief Features and location of one figure of a multi figure picture.
+ */
+struct FigureInspection {
+    cv::RotatedRect location; // location within the source picture
+    cv::Mat pic;              // cut out and horizantally rotated figure
+    InspectionResult result;
+};
+
+/**
+ * @brief Lego figure inspector.
+ * Owns one complete set of workers (figure finder + feature finders). Workers are not
+ * shared between threads, so every thread has to use its own inspector.
+ */
+class Inspector : public giri::Object<Inspector> {
+public:
+
+    /**
+     * CTor
+     * @param bg Background picture to be used for brightness adjustment.
+     * @param templFace Example template used to match the face.
+     * @param templLarm Example template used to match the left arm.
+     * @param templRarm Example template used to match the right arm.
+     * @param inf if true blocking windows showing a graphical result of every worker will be displayed.
+     * @param mode Segmentation mode used by the figure finder.
+     * @param track if true the figure finder reuses its last result while the figure does not move.
+     * @param previewScale Downscale factor of the previews passed to the preview variant of DoWork().
+     */
+    Inspector(const cv::Mat& bg, const cv::Mat& templFace, const cv::Mat& templLarm, const cv::Mat& templRarm, bool inf = false,
+              FindFigure::shift_mode mode = FindFigure::precise, bool track = false, int previewScale = 1);
+
+    /**
+     * Finds the figure and checks all of its features.
+     * @param pic [in/out] Picture to be inspected. Outputs cut out and horizantally rotated figure.
+     * @return Found features, figure is false if no figure was detected.
+     */
+    InspectionResult DoWork(cv::Mat& pic);
+
+    /**
+     * Searches the figure on a downscaled preview, the full picture is only needed if a figure was found.
+     * Only the normalization samples the full picture.
+     * @param preview Picture downscaled by previewScale (sizes rounded up).
+     * @param decode Returns the full resolution picture, empty if it could not be decoded.
+     * @param pic [out] Cut out and horizantally rotated figure, empty if no figure was found.
+     * @return Found features, figure is false if no figure was detected.
+     */
+    InspectionResult DoWork(const cv::Mat& preview, const std::function<cv::Mat()>& decode, cv::Mat& pic);
+
+    /**
+     * Finds all figures on the picture and checks the features of each one.
+     * @param pic Picture to be inspected.
+     * @param threads Number of figures checked in parallel, ignored if steps are visualized.
+     * @return One entry per found figure.
+     */
+    std::vector<FigureInspection> DoWorkAll(const cv::Mat& pic, size_t threads = 1);
+
+    /**
+     * Checks the features of an already normalized figure, skips the figure finder.
+     * @param figure Cut out and horizantally rotated figure, as output by DoWork().
+     * @return Found features.
+     */
+    InspectionResult CheckFeatures(cv::Mat& figure);
+
+    /**
+     * @return Parameters of the figure finders and the color ranges of all feature finders, for the result cache.
+     */
+    std::string GetConfig() const;
+
+    using SPtr = std::shared_ptr<Inspector>;
+    using UPtr = std::unique_ptr<Inspector>;
+    using WPtr = std::weak_ptr<Inspector>;
+
+private:
+
+    /**
+     * @brief One complete set of feature finders, used by one thread at a time.
+     */
+    struct Features {
+        IPicWorker::SPtr m_HeadFinder;
+        IPicWorker::SPtr m_HatFinder;
+        IPicWorker::SPtr m_LeftHandFinder;
+        IPicWorker::SPtr m_RightHandFinder;
+        IPicWorker::SPtr m_RightFootFinder;
+        IPicWorker::SPtr m_LeftFootFinder;
+        IPicWorker::SPtr m_BodyPrintFinder;
+        IPicWorker::SPtr m_FacePrintFinder;
+        IPicWorker::SPtr m_LeftArmFinder;
+        IPicWorker::SPtr m_RightArmFinder;
+        PicContext m_Context;
+    };
+
+    Features makeFeatures() const;
+    InspectionResult inspect(Features& features, cv::Mat& figure);
+
+    cv::Mat m_TemplFace;
+    cv::Mat m_TemplLarm;
+    cv::Mat m_TemplRarm;
+    bool m_ShowInfo;
+
+    FindFigure::SPtr m_Cutter;
+    FindFigure::SPtr m_Locator; // figure finder working on previews
+    int m_PreviewScale;
+    std::vector<Features> m_Features; // first set is used for single figure pictures
+    std::vector<FindFigure::Figure> m_Figures;
+};
+
+#endif // INSPECTOR_H
@@ -0,0 +1,64 @@
+/**
+ * @file JpegDecoder.cpp
+ * @brief Class which decodes JPEG pictures at full or reduced scale into reused buffers.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#include "JpegDecoder.h"
+
+#include <opencv2/imgproc.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <turbojpeg.h>
+
+JpegDecoder::JpegDecoder() : m_Handle(tjInitDecompress()){
+}
+
+JpegDecoder::~JpegDecoder(){
+    if(m_Handle)
+        tjDestroy(m_Handle);
+}
+
+bool JpegDecoder::Decode(const uchar* data, size_t size, int denom, cv::Mat& pic){
+    CV_Assert(denom == 1 || denom == 2 || denom == 4 || denom == 8);
+    if(size == 0)
+        return false;
+    cv::Mat& buf = m_Buffers[denom];
+
+    // no jpeg, let opencv decode it
+    int width, height, subsamp, colorspace;
+    if(!m_Handle || tjDecompressHeader3(m_Handle, data, size, &width, &height, &subsamp, &colorspace) != 0)
+        return decodeOther(data, size, denom, buf, pic);
+
+    // libjpeg-turbo chooses the dct scaling factor which fits into the given size
+    tjscalingfactor sf = {1, denom};
+    buf.create(TJSCALED(height, sf), TJSCALED(width, sf), CV_8UC3);
+    if(tjDecompress2(m_Handle, data, size, buf.data, buf.cols, static_cast<int>(buf.step), buf.rows, TJPF_BGR, 0) != 0){
+#ifdef TJ_NUMERR
+        // recoverable problems (premature end of file, extraneous bytes) still decode the
+        // picture, like cv::imread does
+        if(tjGetErrorCode(m_Handle) != TJERR_WARNING)
+            return decodeOther(data, size, denom, buf, pic);
+#else
+        return decodeOther(data, size, denom, buf, pic);
+#endif
+    }
+    pic = buf;
+    return true;
+}
+
+bool JpegDecoder::decodeOther(const uchar* data, size_t size, int denom, cv::Mat& buf, cv::Mat& pic){
+    // decoded without copying the data
+    cv::Mat full = cv::imdecode(cv::Mat(1, static_cast<int>(size), CV_8UC1, const_cast<uchar*>(data)), cv::IMREAD_COLOR);
+    if(full.empty())
+        return false;
+    if(denom == 1)
+        full.copyTo(buf);
+    else
+        cv::resize(full, buf, cv::Size((full.cols + denom - 1) / denom, (full.rows + denom - 1) / denom), 0, 0, cv::INTER_AREA);
+    pic = buf;
+    return true;
+}
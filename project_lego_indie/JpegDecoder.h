@@ -0,0 +1,64 @@
+/**
+ * @file JpegDecoder.h
+ * @brief Class which decodes JPEG pictures at full or reduced scale into reused buffers.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#ifndef JPEGDECODER_H
+#define JPEGDECODER_H
+
+#include <map>
+#include <opencv2/core.hpp>
+#include <Object.h>
+
+/**
+ * @brief JPEG decoder based on libjpeg-turbo.
+ * Reduced scales use the DCT scaling of libjpeg-turbo, so only a fraction of the picture is
+ * decoded. Every scale has its own buffer which is reused from picture to picture. Pictures
+ * which are no JPEGs or which libjpeg-turbo rejects are decoded by OpenCV (and resized for
+ * reduced scales). Unlike cv::imread the EXIF orientation of JPEGs is not applied.
+ * Not thread safe, every thread has to use its own decoder.
+ */
+class JpegDecoder : public giri::Object<JpegDecoder> {
+public:
+
+    /**
+     * CTor
+     */
+    JpegDecoder();
+
+    /**
+     * DTor
+     */
+    virtual ~JpegDecoder();
+
+    JpegDecoder(const JpegDecoder&) = delete;
+    JpegDecoder& operator=(const JpegDecoder&) = delete;
+
+    /**
+     * Decodes a picture.
+     * @param data Encoded picture.
+     * @param size Size of the encoded picture in bytes.
+     * @param denom Scale denominator, 1, 2, 4 or 8.
+     * @param pic [out] BGR picture of size ceil(width / denom) x ceil(height / denom). Shares
+     *            the buffer of this decoder, valid until the next call with the same denominator.
+     * @return false if the data could not be decoded.
+     */
+    bool Decode(const uchar* data, size_t size, int denom, cv::Mat& pic);
+
+    using SPtr = std::shared_ptr<JpegDecoder>;
+    using UPtr = std::unique_ptr<JpegDecoder>;
+    using WPtr = std::weak_ptr<JpegDecoder>;
+
+private:
+    bool decodeOther(const uchar* data, size_t size, int denom, cv::Mat& buf, cv::Mat& pic);
+
+    void* m_Handle;
+    std::map<int, cv::Mat> m_Buffers; // one buffer per scale denominator
+};
+
+#endif // JPEGDECODER_H
@@ -0,0 +1,126 @@
+/**
+ * @file PicArchive.cpp
+ * @brief Class which packs encoded pictures into one indexed file and reads them memory mapped.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#include "PicArchive.h"
+
+#include <fstream>
+#include <cstring>
+
+namespace {
+    const char Magic[4] = {'L', 'N', 'A', '1'};
+
+    struct Header {
+        char magic[4];
+        uint32_t reserved;
+        uint64_t count;
+        uint64_t indexOffset;
+    };
+}
+
+bool PicArchive::Pack(const std::vector<std::filesystem::path>& files, const std::filesystem::path& archive){
+    std::ofstream out(archive, std::ios::binary | std::ios::trunc);
+    if(!out)
+        return false;
+
+    // placeholder, the final header is written after the index
+    Header header = {};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<char> index;
+    std::vector<char> buf;
+    uint64_t offset = sizeof(header);
+    for(const auto& f : files){
+        std::ifstream in(f, std::ios::binary | std::ios::ate);
+        if(!in)
+            return false;
+        buf.resize(static_cast<size_t>(in.tellg()));
+        in.seekg(0);
+        if(!in.read(buf.data(), buf.size()) || !out.write(buf.data(), buf.size()))
+            return false;
+
+        uint64_t size = buf.size();
+        std::string name = f.filename().string();
+        uint32_t len = static_cast<uint32_t>(name.size());
+        size_t pos = index.size();
+        index.resize(pos + sizeof(offset) + sizeof(size) + sizeof(len) + len);
+        std::memcpy(&index[pos], &offset, sizeof(offset));
+        std::memcpy(&index[pos + sizeof(offset)], &size, sizeof(size));
+        std::memcpy(&index[pos + sizeof(offset) + sizeof(size)], &len, sizeof(len));
+        std::memcpy(&index[pos + sizeof(offset) + sizeof(size) + sizeof(len)], name.data(), len);
+        offset += size;
+    }
+
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.count = files.size();
+    header.indexOffset = offset;
+    out.write(index.data(), index.size());
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    return static_cast<bool>(out.flush());
+}
+
+PicArchive::PicArchive(const std::filesystem::path& archive){
+    try{
+        m_File.open(archive.string());
+    }
+    catch(const std::exception&){
+        return;
+    }
+    m_Valid = parse();
+}
+
+bool PicArchive::parse(){
+    const char* data = m_File.data();
+    size_t size = m_File.size();
+    Header header;
+    if(size < sizeof(header))
+        return false;
+    std::memcpy(&header, data, sizeof(header));
+    if(std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.indexOffset > size)
+        return false;
+
+    size_t pos = header.indexOffset;
+    for(uint64_t i = 0; i < header.count; i++){
+        Entry e;
+        uint32_t len;
+        if(size - pos < sizeof(e.offset) + sizeof(e.size) + sizeof(len))
+            return false;
+        std::memcpy(&e.offset, data + pos, sizeof(e.offset));
+        std::memcpy(&e.size, data + pos + sizeof(e.offset), sizeof(e.size));
+        std::memcpy(&len, data + pos + sizeof(e.offset) + sizeof(e.size), sizeof(len));
+        pos += sizeof(e.offset) + sizeof(e.size) + sizeof(len);
+        if(size - pos < len || e.offset > header.indexOffset || e.size > header.indexOffset - e.offset)
+            return false;
+        e.name.assign(data + pos, len);
+        pos += len;
+        m_Entries.push_back(std::move(e));
+    }
+    return true;
+}
+
+bool PicArchive::IsOpened() const{
+    return m_Valid;
+}
+
+size_t PicArchive::GetCount() const{
+    return m_Valid ? m_Entries.size() : 0;
+}
+
+const std::string& PicArchive::GetName(size_t i) const{
+    return m_Entries.at(i).name;
+}
+
+const unsigned char* PicArchive::GetData(size_t i) const{
+    return reinterpret_cast<const unsigned char*>(m_File.data()) + m_Entries.at(i).offset;
+}
+
+size_t PicArchive::GetSize(size_t i) const{
+    return m_Entries.at(i).size;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file PicArchive.h
+ * @brief Class which packs encoded pictures into one indexed file and reads them memory mapped.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#ifndef PICARCHIVE_H
+#define PICARCHIVE_H
+
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <Object.h>
+
+/**
+ * @brief Picture archive.
+ * Layout: header (magic "LNA1", uint32 reserved, uint64 count, uint64 index offset) |
+ * encoded pictures back to back | index with uint64 offset, uint64 size, uint32 name length
+ * and name per picture. All values are stored in host byte order.
+ * Reading one archive replaces the open/stat/read of every single picture by one mapping.
+ */
+class PicArchive : public giri::Object<PicArchive> {
+public:
+
+    /**
+     * Packs files into a new archive, in the given order.
+     * @param files Encoded pictures to be packed.
+     * @param archive Archive to be created, an existing file gets replaced.
+     * @return false if a file could not be read or the archive could not be written.
+     */
+    static bool Pack(const std::vector<std::filesystem::path>& files, const std::filesystem::path& archive);
+
+    /**
+     * CTor, maps the archive.
+     * @param archive Archive created by Pack().
+     */
+    explicit PicArchive(const std::filesystem::path& archive);
+
+    /**
+     * @return true if the archive could be mapped and has a valid layout.
+     */
+    bool IsOpened() const;
+
+    /**
+     * @return Number of pictures within the archive.
+     */
+    size_t GetCount() const;
+
+    /**
+     * @param i Picture index.
+     * @return Name of the packed file.
+     */
+    const std::string& GetName(size_t i) const;
+
+    /**
+     * @param i Picture index.
+     * @return Encoded picture within the mapping.
+     */
+    const unsigned char* GetData(size_t i) const;
+
+    /**
+     * @param i Picture index.
+     * @return Size of the encoded picture in bytes.
+     */
+    size_t GetSize(size_t i) const;
+
+    using SPtr = std::shared_ptr<PicArchive>;
+    using UPtr = std::unique_ptr<PicArchive>;
+    using WPtr = std::weak_ptr<PicArchive>;
+
+private:
+    struct Entry {
+        uint64_t offset;
+        uint64_t size;
+        std::string name;
+    };
+
+    bool parse();
+
+    boost::iostreams::mapped_file_source m_File;
+    std::vector<Entry> m_Entries;
+    bool m_Valid = false;
+};
+
+#endif // PICARCHIVE_H
@@ -0,0 +1,57 @@
+/**
+ * @file PicContext.cpp
+ * @brief Per picture analysis context shared between all workers analyzing the same picture.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#include "PicContext.h"
+
+#include <opencv2/imgproc.hpp>
+
+#include "RangeCount.h"
+
+PicContext::PicContext(const cv::Mat& pic){
+    Reset(pic);
+}
+
+PicContext::PicContext(const ColorClassifier::SPtr& classifier) : m_Classifier(classifier){
+}
+
+void PicContext::Reset(const cv::Mat& pic){
+    m_Pic = pic;
+    m_HasHSV = false;
+    m_ClassRows.assign(pic.rows, 0);
+}
+
+const cv::Mat& PicContext::GetPic() const{
+    return m_Pic;
+}
+
+const cv::Mat& PicContext::GetHSV(){
+    if(!m_HasHSV){
+        cv::cvtColor(m_Pic, m_HSV, cv::COLOR_BGR2HSV);
+        m_HasHSV = true;
+    }
+    return m_HSV;
+}
+
+int PicContext::CountInRange(const cv::Rect& roi, const cv::Scalar& lower, const cv::Scalar& upper, int limit){
+    int idx = m_Classifier ? m_Classifier->GetIndex(lower, upper) : -1;
+    if(idx < 0)
+        return countInRangeUpTo(GetHSV()(roi), lower, upper, limit);
+
+    m_Classes.create(m_Pic.size(), CV_8UC1);
+    int cnt = 0;
+    for(int y = roi.y; y < roi.y + roi.height && cnt < limit; y++){
+        if(!m_ClassRows[y]){
+            m_Classifier->ClassifyRow(m_Pic.ptr<uchar>(y), m_Classes.ptr<uchar>(y), m_Pic.cols);
+            m_ClassRows[y] = 1;
+        }
+        cnt += countBitsRow(m_Classes.ptr<uchar>(y) + roi.x, roi.width, static_cast<uchar>(1 << idx));
+    }
+    return cnt;
+}
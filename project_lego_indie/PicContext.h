@@ -0,0 +1,80 @@
+/**
+ * @file PicContext.h
+ * @brief Per picture analysis context shared between all workers analyzing the same picture.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#ifndef PICCONTEXT_H
+#define PICCONTEXT_H
+
+#include <opencv2/core.hpp>
+
+#include <vector>
+#include <climits>
+
+#include "ColorClassifier.h"
+
+/**
+ * @brief Analysis context of one picture.
+ * Derived planes (e.g. HSV, color classes) are computed lazily on first use and then shared by all workers.
+ * Buffers are kept when switching to the next picture, so a context should be reused.
+ */
+class PicContext {
+public:
+    PicContext() = default;
+
+    /**
+     * CTor
+     * @param pic Picture to be analyzed. (BGR)
+     */
+    explicit PicContext(const cv::Mat& pic);
+
+    /**
+     * CTor
+     * @param classifier Classifier used to count color ranges in a single pass over the picture.
+     */
+    explicit PicContext(const ColorClassifier::SPtr& classifier);
+
+    /**
+     * Switches the context to a new picture, all derived planes get invalid.
+     * @param pic Picture to be analyzed. (BGR)
+     */
+    void Reset(const cv::Mat& pic);
+
+    /**
+     * @return Picture this context belongs to. (BGR)
+     */
+    const cv::Mat& GetPic() const;
+
+    /**
+     * @return Picture converted to HSV, converted on first call only.
+     */
+    const cv::Mat& GetHSV();
+
+    /**
+     * Counts the pixels within the given HSV range, same result as cv::inRange + cv::countNonZero.
+     * Ranges known to the classifier are counted on the color class plane, which is computed
+     * once for all ranges, others fall back to the HSV plane. Scanning stops as soon as limit
+     * pixels were found, class plane rows are only computed when a scan reaches them.
+     * @param roi Region of the picture to be searched.
+     * @param lower Lower HSV bound.
+     * @param upper Upper HSV bound.
+     * @param limit Counting stops as soon as this number of pixels was found.
+     * @return Number of pixels within the range, if limit was reached the value is >= limit.
+     */
+    int CountInRange(const cv::Rect& roi, const cv::Scalar& lower, const cv::Scalar& upper, int limit = INT_MAX);
+
+private:
+    cv::Mat m_Pic;
+    cv::Mat m_HSV;
+    bool m_HasHSV = false;
+    ColorClassifier::SPtr m_Classifier;
+    cv::Mat m_Classes;
+    std::vector<uchar> m_ClassRows; // rows of m_Classes already classified
+};
+
+#endif // PICCONTEXT_H
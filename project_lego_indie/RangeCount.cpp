@@ -0,0 +1,77 @@
+/**
+ * @file RangeCount.cpp
+ * @brief Short circuiting pixel counting primitives used by the presence detectors.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#include "RangeCount.h"
+
+#include <opencv2/core/hal/intrin.hpp>
+
+#include <bitset>
+#include <type_traits>
+
+namespace {
+
+template<typename T>
+inline int popCount(T mask){
+    return static_cast<int>(std::bitset<sizeof(T) * 8>(static_cast<typename std::make_unsigned<T>::type>(mask)).count());
+}
+
+} // namespace
+
+int countInRangeRow(const uchar* src, int n, const uchar lower[3], const uchar upper[3]){
+    int cnt = 0, x = 0;
+#if CV_SIMD
+    const cv::v_uint8 l0 = cv::vx_setall_u8(lower[0]), l1 = cv::vx_setall_u8(lower[1]), l2 = cv::vx_setall_u8(lower[2]);
+    const cv::v_uint8 u0 = cv::vx_setall_u8(upper[0]), u1 = cv::vx_setall_u8(upper[1]), u2 = cv::vx_setall_u8(upper[2]);
+    for(; x <= n - cv::v_uint8::nlanes; x += cv::v_uint8::nlanes){
+        cv::v_uint8 c0, c1, c2;
+        cv::v_load_deinterleave(src + 3 * x, c0, c1, c2);
+        cv::v_uint8 m = (c0 >= l0) & (c0 <= u0) & (c1 >= l1) & (c1 <= u1) & (c2 >= l2) & (c2 <= u2);
+        cnt += popCount(cv::v_signmask(m));
+    }
+    cv::vx_cleanup();
+#endif
+    for(; x < n; x++){
+        const uchar* p = src + 3 * x;
+        cnt += p[0] >= lower[0] && p[0] <= upper[0] &&
+               p[1] >= lower[1] && p[1] <= upper[1] &&
+               p[2] >= lower[2] && p[2] <= upper[2];
+    }
+    return cnt;
+}
+
+int countBitsRow(const uchar* src, int n, uchar bits){
+    int cnt = 0, x = 0;
+#if CV_SIMD
+    const cv::v_uint8 vbits = cv::vx_setall_u8(bits), vzero = cv::vx_setzero_u8();
+    for(; x <= n - cv::v_uint8::nlanes; x += cv::v_uint8::nlanes){
+        cv::v_uint8 m = (cv::vx_load(src + x) & vbits) != vzero;
+        cnt += popCount(cv::v_signmask(m));
+    }
+    cv::vx_cleanup();
+#endif
+    for(; x < n; x++)
+        cnt += (src[x] & bits) != 0;
+    return cnt;
+}
+
+int countInRangeUpTo(const cv::Mat& src, const cv::Scalar& lower, const cv::Scalar& upper, int limit){
+    CV_Assert(src.type() == CV_8UC3);
+    // bounds are saturated to the picture depth like cv::inRange does
+    uchar lo[3], up[3];
+    for(int c = 0; c < 3; c++){
+        lo[c] = cv::saturate_cast<uchar>(lower[c]);
+        up[c] = cv::saturate_cast<uchar>(upper[c]);
+    }
+
+    int cnt = 0;
+    for(int y = 0; y < src.rows && cnt < limit; y++)
+        cnt += countInRangeRow(src.ptr<uchar>(y), src.cols, lo, up);
+    return cnt;
+}
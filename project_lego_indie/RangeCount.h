@@ -0,0 +1,46 @@
+/**
+ * @file RangeCount.h
+ * @brief Short circuiting pixel counting primitives used by the presence detectors.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#ifndef RANGECOUNT_H
+#define RANGECOUNT_H
+
+#include <opencv2/core.hpp>
+
+/**
+ * Counts the pixels of one row which lie within the given inclusive range (vectorized).
+ * @param src Row of a CV_8UC3 picture.
+ * @param n Number of pixels in the row.
+ * @param lower Lower bound per channel.
+ * @param upper Upper bound per channel.
+ * @return Number of pixels within the range.
+ */
+int countInRangeRow(const uchar* src, int n, const uchar lower[3], const uchar upper[3]);
+
+/**
+ * Counts the pixels of one row which have any of the given bits set (vectorized).
+ * @param src Row of a CV_8UC1 plane.
+ * @param n Number of pixels in the row.
+ * @param bits Bits to test.
+ * @return Number of pixels having any of the bits set.
+ */
+int countBitsRow(const uchar* src, int n, uchar bits);
+
+/**
+ * Counts the pixels of a picture within the given range like cv::inRange + cv::countNonZero,
+ * but stops scanning after the row where limit is reached.
+ * @param src Picture to be scanned. (CV_8UC3)
+ * @param lower Lower bound.
+ * @param upper Upper bound.
+ * @param limit Counting stops as soon as this number of pixels was found.
+ * @return Number of pixels within the range, if limit was reached the value is >= limit.
+ */
+int countInRangeUpTo(const cv::Mat& src, const cv::Scalar& lower, const cv::Scalar& upper, int limit);
+
+#endif // RANGECOUNT_H
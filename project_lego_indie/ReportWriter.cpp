@@ -0,0 +1,190 @@
+/**
+ * @file ReportWriter.cpp
+ * @brief Class which formats the inspection results and writes them in large blocks.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#include "ReportWriter.h"
+
+#include <algorithm>
+
+#include "StreamProtocol.h"
+
+/**
+ * Appends printf formatted text.
+ */
+template<typename... Args>
+static void appendf(std::string& out, const char* fmt, Args... args){
+    char buf[128];
+    int n = std::snprintf(buf, sizeof(buf), fmt, args...);
+    if(n > 0)
+        out.append(buf, std::min<size_t>(n, sizeof(buf) - 1));
+}
+
+/**
+ * Appends a string as quoted JSON string.
+ */
+static void appendJsonString(std::string& out, const std::string& str){
+    out += '"';
+    for(char c : str){
+        if(c == '"' || c == '\\'){
+            out += '\\';
+            out += c;
+        }
+        else if(static_cast<unsigned char>(c) < 0x20){
+            appendf(out, "\\u%04x", static_cast<unsigned>(c));
+        }
+        else{
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+/**
+ * Appends a string as quoted CSV field.
+ */
+static void appendCsvString(std::string& out, const std::string& str){
+    out += '"';
+    for(char c : str){
+        if(c == '"')
+            out += '"';
+        out += c;
+    }
+    out += '"';
+}
+
+/**
+ * Appends one line per feature.
+ */
+static void appendFeatures(std::string& out, const InspectionResult& res){
+    auto b = [](bool v){ return v ? "true\n" : "false\n"; };
+    out += "Hat       -> "; out += b(res.hat);
+    out += "Head      -> "; out += b(res.head);
+    out += "Left Hand -> "; out += b(res.leftHand);
+    out += "Right Hand-> "; out += b(res.rightHand);
+    out += "Left Arm  -> "; out += b(res.leftArm);
+    out += "Right Arm -> "; out += b(res.rightArm);
+    out += "Left Foot -> "; out += b(res.leftFoot);
+    out += "Right Foot-> "; out += b(res.rightFoot);
+    out += "Face      -> "; out += b(res.facePrint);
+    out += "Body Print-> "; out += b(res.bodyPrint);
+}
+
+bool ReportWriter::Parse(const std::string& name, format_t& fmt){
+    const std::pair<const char*, format_t> formats[] = {{"text", text}, {"jsonl", jsonl}, {"csv", csv}, {"bin", bin}};
+    for(const auto& f : formats){
+        if(name == f.first){
+            fmt = f.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+ReportWriter::ReportWriter(format_t fmt, bool multi, std::FILE* out, size_t blockSize) :
+    m_Format(fmt), m_Multi(multi), m_Out(out), m_BlockSize(blockSize)
+{
+    m_Block.reserve(m_BlockSize);
+    if(m_Format == csv)
+        m_Block += "idx,path,ms,figure,bits,cx,cy,w,h,angle\n";
+}
+
+ReportWriter::~ReportWriter(){
+    Flush();
+}
+
+std::string ReportWriter::Format(size_t idx, const std::string& name, const std::vector<FigureInspection>& res, bool failed, double seconds) const{
+    std::string out;
+    switch(m_Format){
+    case text:  formatText(out, name, res); break;
+    case jsonl: formatJson(out, idx, name, res, failed, seconds); break;
+    case csv:   formatCsv(out, idx, name, res, failed, seconds); break;
+    case bin:   formatBin(out, idx, name, res, failed, seconds); break;
+    }
+    return out;
+}
+
+void ReportWriter::Write(const std::string& str){
+    if(m_Block.size() + str.size() > m_BlockSize)
+        Flush();
+    m_Block += str;
+}
+
+void ReportWriter::Flush(){
+    if(!m_Block.empty())
+        std::fwrite(m_Block.data(), 1, m_Block.size(), m_Out);
+    m_Block.clear();
+    std::fflush(m_Out);
+}
+
+void ReportWriter::formatText(std::string& out, const std::string& name, const std::vector<FigureInspection>& res) const{
+    if(res.empty()){
+        out += name + ": No indie detected!\n";
+        return;
+    }
+    out += "#############################################\n";
+    out += "File #" + name + "\n";
+    for(size_t i = 0; i < res.size(); i++){
+        out += "---------------------------------------------\n";
+        if(m_Multi){
+            const auto& loc = res[i].location;
+            appendf(out, "Figure #%zu at (%d, %d), %dx%d, angle %g\n", i, cvRound(loc.center.x), cvRound(loc.center.y),
+                    cvRound(loc.size.width), cvRound(loc.size.height), loc.angle);
+        }
+        appendFeatures(out, res[i].result);
+    }
+    out += "#############################################\n";
+}
+
+void ReportWriter::formatJson(std::string& out, size_t idx, const std::string& name, const std::vector<FigureInspection>& res, bool failed, double seconds) const{
+    appendf(out, "{\"idx\":%zu,\"path\":", idx);
+    appendJsonString(out, name);
+    appendf(out, ",\"ms\":%.3f,", seconds * 1000);
+    if(failed){
+        out += "\"error\":\"unreadable\"}\n";
+        return;
+    }
+    out += "\"figures\":[";
+    for(size_t i = 0; i < res.size(); i++){
+        const auto& loc = res[i].location;
+        appendf(out, "%s{\"bits\":%u,\"cx\":%g,\"cy\":%g,\"w\":%g,\"h\":%g,\"angle\":%g}", i ? "," : "",
+                static_cast<unsigned>(ToBits(res[i].result)), loc.center.x, loc.center.y, loc.size.width, loc.size.height, loc.angle);
+    }
+    out += "]}\n";
+}
+
+void ReportWriter::formatCsv(std::string& out, size_t idx, const std::string& name, const std::vector<FigureInspection>& res, bool failed, double seconds) const{
+    auto prefix = [&](){
+        appendf(out, "%zu,", idx);
+        appendCsvString(out, name);
+        appendf(out, ",%.3f,", seconds * 1000);
+    };
+    if(failed || res.empty()){
+        prefix();
+        out += failed ? "-1,0,0,0,0,0,0\n" : ",0,0,0,0,0,0\n";
+        return;
+    }
+    for(size_t i = 0; i < res.size(); i++){
+        const auto& loc = res[i].location;
+        prefix();
+        appendf(out, "%zu,%u,%g,%g,%g,%g,%g\n", i, static_cast<unsigned>(ToBits(res[i].result)),
+                loc.center.x, loc.center.y, loc.size.width, loc.size.height, loc.angle);
+    }
+}
+
+void ReportWriter::formatBin(std::string& out, size_t idx, const std::string& name, const std::vector<FigureInspection>& res, bool failed, double seconds) const{
+    uint32_t head[2] = {static_cast<uint32_t>(idx), failed ? StreamRecord::Failed : static_cast<uint32_t>(res.size())};
+    float ms = static_cast<float>(seconds * 1000);
+    uint32_t len = static_cast<uint32_t>(name.size());
+    out.append(reinterpret_cast<const char*>(head), sizeof(head));
+    out.append(reinterpret_cast<const char*>(&ms), sizeof(ms));
+    out.append(reinterpret_cast<const char*>(&len), sizeof(len));
+    out += name;
+    if(!failed)
+        appendFigures(out, res);
+}
@@ -0,0 +1,100 @@
+/**
+ * @file ReportWriter.h
+ * @brief Class which formats the inspection results and writes them in large blocks.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#ifndef REPORTWRITER_H
+#define REPORTWRITER_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <Object.h>
+
+#include "Inspector.h"
+
+/**
+ * @brief Report writer.
+ * Formats:
+ *  - text:  human readable report, one block per picture.
+ *  - jsonl: one JSON object per picture: idx, path, ms, figures [{bits, cx, cy, w, h, angle}],
+ *           pictures which could not be read carry "error" instead of figures.
+ *  - csv:   header line, then one row per figure: idx, path, ms, figure, bits, cx, cy, w, h, angle.
+ *           pictures without a figure get one row with an empty figure column, unreadable ones -1.
+ *  - bin:   per picture uint32 idx, uint32 count (StreamRecord::Failed if unreadable), float ms,
+ *           uint32 path length, path, count FigureRecord entries. Host byte order.
+ * bits are the features packed by ToBits(), locations are zero in single figure mode.
+ * Formatting is thread safe, writing is not.
+ */
+class ReportWriter : public giri::Object<ReportWriter> {
+public:
+
+    enum format_t { text, jsonl, csv, bin };
+
+    /**
+     * Looks up a format by its name.
+     * @param name One of text, jsonl, csv, bin.
+     * @param fmt [out] Format.
+     * @return false if the name is unknown.
+     */
+    static bool Parse(const std::string& name, format_t& fmt);
+
+    /**
+     * CTor
+     * @param fmt Format of the reports.
+     * @param multi true if every figure of a picture is reported, text reports of single figure mode have no locations.
+     * @param out Stream the reports are written to.
+     * @param blockSize Reports are collected until a block of this size is full.
+     */
+    ReportWriter(format_t fmt, bool multi, std::FILE* out = stdout, size_t blockSize = 1 << 20);
+
+    /**
+     * DTor, writes the remaining reports.
+     */
+    ~ReportWriter();
+
+    /**
+     * Formats the report of one picture.
+     * @param idx Index of the picture within its source.
+     * @param name File or frame the result belongs to.
+     * @param res Found figures.
+     * @param failed true if the picture could not be read.
+     * @param seconds Time spent on the picture.
+     * @return Formatted report, to be passed to Write().
+     */
+    std::string Format(size_t idx, const std::string& name, const std::vector<FigureInspection>& res, bool failed, double seconds) const;
+
+    /**
+     * Appends already formatted output, the block is written once it is full.
+     * @param str Formatted output.
+     */
+    void Write(const std::string& str);
+
+    /**
+     * Writes the collected output, to be called at batch boundaries.
+     */
+    void Flush();
+
+    using SPtr = std::shared_ptr<ReportWriter>;
+    using UPtr = std::unique_ptr<ReportWriter>;
+    using WPtr = std::weak_ptr<ReportWriter>;
+
+private:
+    void formatText(std::string& out, const std::string& name, const std::vector<FigureInspection>& res) const;
+    void formatJson(std::string& out, size_t idx, const std::string& name, const std::vector<FigureInspection>& res, bool failed, double seconds) const;
+    void formatCsv(std::string& out, size_t idx, const std::string& name, const std::vector<FigureInspection>& res, bool failed, double seconds) const;
+    void formatBin(std::string& out, size_t idx, const std::string& name, const std::vector<FigureInspection>& res, bool failed, double seconds) const;
+
+    format_t m_Format;
+    bool m_Multi;
+    std::FILE* m_Out;
+    size_t m_BlockSize;
+    std::string m_Block;
+};
+
+#endif // REPORTWRITER_H
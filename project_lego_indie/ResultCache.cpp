@@ -0,0 +1,104 @@
+/**
+ * @file ResultCache.cpp
+ * @brief Class which stores inspection results on disk, addressed by the picture content.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#include "ResultCache.h"
+
+#include <fstream>
+#include <random>
+#include <cstring>
+
+namespace {
+    // entry layout: magic, figure count, per figure location (cx, cy, w, h, angle) and feature bits
+    const char Magic[4] = {'L', 'N', 'C', '1'};
+
+    struct Record {
+        float loc[5];
+        uint16_t bits;
+    };
+
+    // stored without padding
+    constexpr uintmax_t HeaderSize = sizeof(Magic) + sizeof(uint32_t);
+    constexpr uintmax_t RecordSize = sizeof(Record::loc) + sizeof(Record::bits);
+}
+
+ResultCache::ResultCache(const std::filesystem::path& dir, const std::string& config) : m_Dir(dir / config){
+    std::filesystem::create_directories(m_Dir);
+}
+
+std::filesystem::path ResultCache::file(const std::string& key) const{
+    // two level layout keeps folders small
+    return m_Dir / key.substr(0, 2) / key;
+}
+
+bool ResultCache::Get(const std::string& key, std::vector<FigureInspection>& res) const{
+    auto src = file(key);
+    std::error_code ec;
+    uintmax_t size = std::filesystem::file_size(src, ec);
+    if(ec || size < HeaderSize)
+        return false;
+    std::ifstream in(src, std::ios::binary);
+    if(!in)
+        return false;
+
+    char magic[sizeof(Magic)];
+    uint32_t cnt = 0;
+    if(!in.read(magic, sizeof(magic)) || std::memcmp(magic, Magic, sizeof(Magic)) != 0 ||
+       !in.read(reinterpret_cast<char*>(&cnt), sizeof(cnt)))
+        return false;
+
+    // a corrupt or foreign entry is a miss, its count must match the file size exactly
+    if(cnt != (size - HeaderSize) / RecordSize || (size - HeaderSize) % RecordSize != 0)
+        return false;
+
+    std::vector<FigureInspection> ret(cnt);
+    for(auto& fig : ret){
+        Record rec;
+        if(!in.read(reinterpret_cast<char*>(&rec.loc), sizeof(rec.loc)) ||
+           !in.read(reinterpret_cast<char*>(&rec.bits), sizeof(rec.bits)))
+            return false;
+        fig.location = cv::RotatedRect(cv::Point2f(rec.loc[0], rec.loc[1]), cv::Size2f(rec.loc[2], rec.loc[3]), rec.loc[4]);
+        fig.result = FromBits(rec.bits);
+    }
+    res = std::move(ret);
+    return true;
+}
+
+void ResultCache::Put(const std::string& key, const std::vector<FigureInspection>& res) const{
+    auto dst = file(key);
+    std::error_code ec;
+    std::filesystem::create_directories(dst.parent_path(), ec);
+
+    // unique temporary name per writer, the rename publishes the complete entry at once
+    static thread_local std::mt19937_64 rng(std::random_device{}());
+    auto tmp = dst;
+    tmp += ".tmp" + std::to_string(rng());
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        uint32_t cnt = static_cast<uint32_t>(res.size());
+        out.write(Magic, sizeof(Magic));
+        out.write(reinterpret_cast<const char*>(&cnt), sizeof(cnt));
+        for(const auto& fig : res){
+            const auto& l = fig.location;
+            Record rec = {{l.center.x, l.center.y, l.size.width, l.size.height, l.angle}, ToBits(fig.result)};
+            out.write(reinterpret_cast<const char*>(&rec.loc), sizeof(rec.loc));
+            out.write(reinterpret_cast<const char*>(&rec.bits), sizeof(rec.bits));
+        }
+        if(!out.flush()){
+            out.close();
+            std::filesystem::remove(tmp, ec);
+            return;
+        }
+    }
+
+    // fails on some platforms if another writer was faster, the entry is the same then
+    std::filesystem::rename(tmp, dst, ec);
+    if(ec)
+        std::filesystem::remove(tmp, ec);
+}
@@ -0,0 +1,73 @@
+/**
+ * @file ResultCache.h
+ * @brief Class which stores inspection results on disk, addressed by the picture content.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <Object.h>
+
+#include "Inspector.h"
+
+/**
+ * @brief Content addressed result cache.
+ * Every entry is one file named by the SHA-256 digest of the encoded picture, stored in a
+ * folder named by the digest of the configuration (background, templates, options, the
+ * parameters of the figure finders and the color ranges of the feature finders, see
+ * Inspector::GetConfig()). Changing any of them never returns stale results, thresholds
+ * written into the code of the finders are not covered, see Version. Results have to be a
+ * function of the picture alone, so tracked results are not cached. Entries are written to a
+ * temporary file and renamed, so concurrent writers (threads or processes) never produce
+ * torn entries.
+ */
+class ResultCache : public giri::Object<ResultCache> {
+public:
+
+    /**
+     * Bump whenever the finders change in a way Inspector::GetConfig() does not show (thresholds
+     * within their code, algorithm changes), old entries are ignored then.
+     */
+    static constexpr const char* Version = "lenet-cache-1";
+
+    /**
+     * CTor
+     * @param dir Cache folder, created if it does not exist.
+     * @param config Digest of the effective configuration.
+     */
+    ResultCache(const std::filesystem::path& dir, const std::string& config);
+
+    /**
+     * Looks up the results of a picture.
+     * @param key Digest of the encoded picture.
+     * @param res [out] Cached figures, without pictures.
+     * @return true on a cache hit.
+     */
+    bool Get(const std::string& key, std::vector<FigureInspection>& res) const;
+
+    /**
+     * Stores the results of a picture, errors are ignored (the cache is an optimization only).
+     * @param key Digest of the encoded picture.
+     * @param res Figures to be stored, pictures are not stored.
+     */
+    void Put(const std::string& key, const std::vector<FigureInspection>& res) const;
+
+    using SPtr = std::shared_ptr<ResultCache>;
+    using UPtr = std::unique_ptr<ResultCache>;
+    using WPtr = std::weak_ptr<ResultCache>;
+
+private:
+    std::filesystem::path file(const std::string& key) const;
+
+    std::filesystem::path m_Dir;
+};
+
+#endif // RESULTCACHE_H
@@ -0,0 +1,53 @@
+/**
+ * @file Sha256.cpp
+ * @brief Class which calculates SHA-256 digests using OpenSSL.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#include "Sha256.h"
+
+#include <stdexcept>
+#include <openssl/evp.h>
+
+Sha256::Sha256() : m_Ctx(EVP_MD_CTX_new()){
+    if(!m_Ctx || EVP_DigestInit_ex(m_Ctx, EVP_sha256(), nullptr) != 1){
+        EVP_MD_CTX_free(m_Ctx);
+        throw std::runtime_error("Could not initialize SHA-256");
+    }
+}
+
+Sha256::~Sha256(){
+    EVP_MD_CTX_free(m_Ctx);
+}
+
+void Sha256::Update(const void* data, size_t len){
+    EVP_DigestUpdate(m_Ctx, data, len);
+}
+
+void Sha256::Update(const std::string& str){
+    Update(str.data(), str.size());
+}
+
+std::string Sha256::HexDigest(){
+    unsigned char md[EVP_MAX_MD_SIZE];
+    unsigned int len = 0;
+    EVP_DigestFinal_ex(m_Ctx, md, &len);
+
+    static const char hex[] = "0123456789abcdef";
+    std::string ret(2 * len, '0');
+    for(unsigned int i = 0; i < len; i++){
+        ret[2 * i] = hex[md[i] >> 4];
+        ret[2 * i + 1] = hex[md[i] & 0xf];
+    }
+    return ret;
+}
+
+std::string Sha256::Of(const void* data, size_t len){
+    Sha256 sha;
+    sha.Update(data, len);
+    return sha.HexDigest();
+}
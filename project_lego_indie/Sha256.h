@@ -0,0 +1,72 @@
+/**
+ * @file Sha256.h
+ * @brief Class which calculates SHA-256 digests using OpenSSL.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <string>
+#include <Object.h>
+
+struct evp_md_ctx_st;
+
+/**
+ * @brief Incremental SHA-256 digest.
+ */
+class Sha256 : public giri::Object<Sha256> {
+public:
+
+    /**
+     * CTor
+     */
+    Sha256();
+
+    /**
+     * DTor
+     */
+    virtual ~Sha256();
+
+    Sha256(const Sha256&) = delete;
+    Sha256& operator=(const Sha256&) = delete;
+
+    /**
+     * Appends data to the digest.
+     * @param data Data to be hashed.
+     * @param len Length of data in bytes.
+     */
+    void Update(const void* data, size_t len);
+
+    /**
+     * Appends a string to the digest.
+     * @param str String to be hashed.
+     */
+    void Update(const std::string& str);
+
+    /**
+     * Finishes the digest, no further updates are allowed afterwards.
+     * @return Digest as lower case hex string.
+     */
+    std::string HexDigest();
+
+    /**
+     * @param data Data to be hashed.
+     * @param len Length of data in bytes.
+     * @return Digest of the data as lower case hex string.
+     */
+    static std::string Of(const void* data, size_t len);
+
+    using SPtr = std::shared_ptr<Sha256>;
+    using UPtr = std::unique_ptr<Sha256>;
+    using WPtr = std::weak_ptr<Sha256>;
+
+private:
+    evp_md_ctx_st* m_Ctx;
+};
+
+#endif // SHA256_H
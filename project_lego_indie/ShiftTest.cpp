@@ -0,0 +1,165 @@
+/**
+ * @file ShiftTest.cpp
+ * @brief Compares the fast with the precise mean shift mode on the labeled pictures. (make shift_test)
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#include <set>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <filesystem>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+#include "Inspector.h"
+
+namespace {
+
+const char* const Features[] = {"figure", "hat", "head", "leftHand", "rightHand", "leftArm",
+                                "rightArm", "leftFoot", "rightFoot", "facePrint", "bodyPrint"};
+constexpr size_t FeatureCount = sizeof(Features) / sizeof(Features[0]);
+
+/**
+ * @brief Labeled folder, the features missing on its pictures.
+ * Folders of one sided defects accept either side.
+ */
+struct Label {
+    const char* folder;
+    std::vector<std::set<std::string>> missing;
+};
+
+const Label Labels[] = {{"0-Normal", {{}}},
+                        {"1-NoHat", {{"hat"}}},
+                        {"2-NoFace", {{"facePrint"}}},
+                        {"3-NoLeg", {{"leftFoot"}, {"rightFoot"}}},
+                        {"4-NoBodyPrint", {{"bodyPrint"}}},
+                        {"5-NoHand", {{"leftHand"}, {"rightHand"}}},
+                        {"6-NoHead", {{"head", "hat", "facePrint"}}},
+                        {"7-NoArm", {{"leftHand", "leftArm"}, {"rightHand", "rightArm"}}}};
+
+/**
+ * @return true if exactly the features of one of the label's alternatives are missing.
+ */
+bool matches(const Label& label, uint16_t bits){
+    std::set<std::string> missing;
+    for(size_t i = 0; i < FeatureCount; i++){
+        if(!((bits >> i) & 1))
+            missing.insert(Features[i]);
+    }
+    return std::find(label.missing.begin(), label.missing.end(), missing) != label.missing.end();
+}
+
+/**
+ * @brief Results of one mode.
+ */
+struct Run {
+    std::vector<uint16_t> bits; // found features per picture
+    size_t correct = 0;         // pictures matching their label
+    double seconds = 0;         // time spent in Inspector::DoWork
+};
+
+/**
+ * Inspects every picture with the given mode, the best of several passes is taken as time.
+ * @param inspector Inspector of the mode.
+ * @param pics Pictures to be inspected.
+ * @param labels Label of every picture.
+ * @param passes Number of passes.
+ */
+Run inspectAll(Inspector& inspector, const std::vector<cv::Mat>& pics, const std::vector<const Label*>& labels, int passes){
+    Run run;
+    run.seconds = 1e30;
+    for(int p = 0; p < passes; p++){
+        run.bits.clear();
+        run.correct = 0;
+        auto start = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < pics.size(); i++){
+            cv::Mat pic = pics[i].clone();
+            run.bits.push_back(ToBits(inspector.DoWork(pic)));
+            run.correct += matches(*labels[i], run.bits.back());
+        }
+        run.seconds = std::min(run.seconds, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return run;
+}
+
+} // namespace
+
+/**
+ * Usage: shift_test [background] [template folder] [picture folder] [passes]
+ * Inspects the labeled folders 0-Normal to 7-NoArm with both mean shift modes on one thread and
+ * prints how often the modes agree per feature, how many pictures match their folder's label
+ * and the time per picture of both modes.
+ */
+int main(int argc, char** argv){
+    const std::filesystem::path bgFile = argc > 1 ? argv[1] : "./pic/Other/image_100.jpg";
+    const std::filesystem::path templDir = argc > 2 ? argv[2] : "./pic/templates";
+    const std::filesystem::path picDir = argc > 3 ? argv[3] : "./pic";
+    const int passes = argc > 4 ? std::max(1, std::atoi(argv[4])) : 3;
+
+    // single threaded, like a worker of the batch mode
+    cv::setNumThreads(0);
+
+    cv::Mat bg = cv::imread(bgFile.string(), cv::IMREAD_COLOR);
+    cv::Mat templFace = cv::imread((templDir / "template_face.png").string(), cv::IMREAD_COLOR);
+    cv::Mat templLarm = cv::imread((templDir / "template_left_arm.png").string(), cv::IMREAD_COLOR);
+    cv::Mat templRarm = cv::imread((templDir / "template_right_arm.png").string(), cv::IMREAD_COLOR);
+    if(bg.empty() || templFace.empty() || templLarm.empty() || templRarm.empty()){
+        std::fprintf(stderr, "Could not read the background or the templates: %s, %s\n", bgFile.string().c_str(), templDir.string().c_str());
+        return EXIT_FAILURE;
+    }
+
+    std::vector<cv::Mat> pics;
+    std::vector<const Label*> labels;
+    for(const auto& label : Labels){
+        std::vector<std::filesystem::path> files;
+        std::error_code ec;
+        for(const auto& entry : std::filesystem::directory_iterator(picDir / label.folder, ec)){
+            if(entry.is_regular_file())
+                files.push_back(entry.path());
+        }
+        std::sort(files.begin(), files.end());
+        for(const auto& f : files){
+            cv::Mat pic = cv::imread(f.string(), cv::IMREAD_COLOR);
+            if(!pic.empty() && pic.size() == bg.size()){
+                pics.push_back(pic);
+                labels.push_back(&label);
+            }
+        }
+    }
+    if(pics.empty()){
+        std::fprintf(stderr, "No labeled pictures of the background size in: %s\n", picDir.string().c_str());
+        return EXIT_FAILURE;
+    }
+
+    Inspector precise(bg, templFace, templLarm, templRarm, false, FindFigure::precise);
+    Inspector fast(bg, templFace, templLarm, templRarm, false, FindFigure::fast);
+    Run p = inspectAll(precise, pics, labels, passes);
+    Run f = inspectAll(fast, pics, labels, passes);
+
+    std::printf("%zu labeled pictures, best of %d passes\n", pics.size(), passes);
+    std::printf("%-12s %16s\n", "feature", "modes agree");
+    size_t same = 0;
+    for(size_t i = 0; i < pics.size(); i++)
+        same += p.bits[i] == f.bits[i];
+    for(size_t b = 0; b < FeatureCount; b++){
+        size_t agree = 0;
+        for(size_t i = 0; i < pics.size(); i++)
+            agree += ((p.bits[i] ^ f.bits[i]) >> b & 1) == 0;
+        std::printf("%-12s %7zu/%zu %5.1f%%\n", Features[b], agree, pics.size(), 100.0 * agree / pics.size());
+    }
+    std::printf("%-12s %7zu/%zu %5.1f%%\n\n", "all", same, pics.size(), 100.0 * same / pics.size());
+    std::printf("%-12s %16s %14s\n", "mode", "label matched", "ms / picture");
+    std::printf("%-12s %7zu/%zu %14.1f\n", "precise", p.correct, pics.size(), 1000 * p.seconds / pics.size());
+    std::printf("%-12s %7zu/%zu %14.1f\n", "fast", f.correct, pics.size(), 1000 * f.seconds / pics.size());
+    std::printf("speedup %.2fx\n", p.seconds / f.seconds);
+    return EXIT_SUCCESS;
+}
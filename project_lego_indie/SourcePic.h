@@ -0,0 +1,33 @@
+/**
+ * @file SourcePic.h
+ * @brief One picture handed from a picture source to the inspection.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#ifndef SOURCEPIC_H
+#define SOURCEPIC_H
+
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+/**
+ * @brief One picture of a source, either still encoded or already decoded.
+ */
+struct SourcePic {
+    size_t idx;
+    std::string name;
+    const uchar* data = nullptr; // encoded picture, null if the source delivers decoded pictures
+    size_t size = 0;             // size of the encoded picture
+    std::vector<uchar> buffer;   // owns the encoded picture for sources which do not keep it themselves
+    cv::Mat pic;
+    bool failed = false;      // picture could not be read
+    bool normalized = false;  // pic already is a normalized figure
+    cv::RotatedRect location; // location of a normalized figure within its source picture
+};
+
+#endif // SOURCEPIC_H
@@ -0,0 +1,124 @@
+/**
+ * @file StageStats.cpp
+ * @brief Latency histograms of the processing stages, filled by scoped timers.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#include "StageStats.h"
+
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <cstdio>
+#include <algorithm>
+
+namespace {
+
+constexpr int SubBits = 4;                          // 16 buckets per power of two
+constexpr int SubCount = 1 << SubBits;
+constexpr int BucketCount = (64 - SubBits + 1) * SubCount;
+
+/**
+ * @return Histogram bucket of a duration.
+ */
+int bucketOf(uint64_t ns){
+    if(ns < SubCount)
+        return static_cast<int>(ns);
+    int e = 63 - __builtin_clzll(ns);
+    return (e - SubBits + 1) * SubCount + static_cast<int>((ns >> (e - SubBits)) & (SubCount - 1));
+}
+
+/**
+ * @return Center of a histogram bucket.
+ */
+double valueOf(int bucket){
+    if(bucket < SubCount)
+        return bucket;
+    int e = bucket / SubCount + SubBits - 1;
+    double width = static_cast<double>(uint64_t(1) << (e - SubBits));
+    return (SubCount + bucket % SubCount) * width + width * 0.5;
+}
+
+/**
+ * @brief Histograms of one thread.
+ */
+struct Histograms {
+    uint64_t count[StageStats::stage_count] = {};
+    uint64_t sum[StageStats::stage_count] = {};
+    uint64_t max[StageStats::stage_count] = {};
+    uint32_t buckets[StageStats::stage_count][BucketCount] = {};
+};
+
+std::mutex g_Mutex;
+std::vector<std::unique_ptr<Histograms>> g_Threads; // kept after their thread ended
+
+Histograms& local(){
+    thread_local Histograms* h = nullptr;
+    if(!h){
+        std::lock_guard<std::mutex> lock(g_Mutex);
+        g_Threads.push_back(std::make_unique<Histograms>());
+        h = g_Threads.back().get();
+    }
+    return *h;
+}
+
+} // namespace
+
+void StageStats::Add(stage_t stage, uint64_t ns){
+    Histograms& h = local();
+    h.count[stage]++;
+    h.sum[stage] += ns;
+    h.max[stage] = std::max(h.max[stage], ns);
+    h.buckets[stage][bucketOf(ns)]++;
+}
+
+const char* StageStats::Name(stage_t stage){
+    static const char* names[stage_count] = {
+        "empty_frame", "crop", "correct_brightness", "track_check", "shift", "make_grey", "make_erode", "make_thresh",
+        "find_contours_ff", "get_transform", "warp_cut", "analyzeLines", "normalize",
+        "head", "hat", "face_print", "left_hand", "left_arm", "right_hand", "right_arm", "left_foot", "right_foot", "body_print",
+        "decode", "picture"
+    };
+    return names[stage];
+}
+
+void StageStats::Report(std::ostream& out){
+    std::lock_guard<std::mutex> lock(g_Mutex);
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-20s %10s %10s %10s %10s %10s %10s\n", "stage [ms]", "count", "mean", "p50", "p90", "p99", "max");
+    out << line;
+
+    std::vector<uint64_t> merged(BucketCount);
+    for(int s = 0; s < stage_count; s++){
+        uint64_t count = 0, sum = 0, max = 0;
+        std::fill(merged.begin(), merged.end(), 0);
+        for(const auto& h : g_Threads){
+            count += h->count[s];
+            sum += h->sum[s];
+            max = std::max(max, h->max[s]);
+            for(int b = 0; b < BucketCount; b++)
+                merged[b] += h->buckets[s][b];
+        }
+        if(count == 0)
+            continue;
+
+        // smallest bucket center which covers the requested share of measurements, capped by the exact max
+        auto percentile = [&](double p){
+            uint64_t rank = static_cast<uint64_t>(p * (count - 1)) + 1;
+            uint64_t seen = 0;
+            for(int b = 0; b < BucketCount; b++){
+                seen += merged[b];
+                if(seen >= rank)
+                    return std::min(valueOf(b), static_cast<double>(max)) / 1e6;
+            }
+            return max / 1e6;
+        };
+        std::snprintf(line, sizeof(line), "%-20s %10llu %10.3f %10.3f %10.3f %10.3f %10.3f\n", Name(static_cast<stage_t>(s)),
+                      static_cast<unsigned long long>(count), sum / 1e6 / count, percentile(0.5), percentile(0.9), percentile(0.99), max / 1e6);
+        out << line;
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ * @file StageStats.h
+ * @brief Latency histograms of the processing stages, filled by scoped timers.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#ifndef STAGESTATS_H
+#define STAGESTATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * @brief Per stage latency statistics.
+ * Every thread records into its own histograms, so timers never contend. Histogram buckets
+ * are log-linear (16 per power of two), percentiles are exact to about 6%, mean and max are exact.
+ * Filled by StageTimer.
+ */
+class StageStats {
+public:
+
+    enum stage_t {
+        empty_frame, crop, correct_brightness, track_check, shift, make_grey, make_erode, make_thresh,
+        find_contours_ff, get_transform, warp_cut, analyze_lines, normalize,
+        head, hat, face_print, left_hand, left_arm, right_hand, right_arm, left_foot, right_foot, body_print,
+        decode, picture,
+        stage_count
+    };
+
+    /**
+     * Starts recording, to be called before any work is started.
+     */
+    static void Enable(){
+        s_Enabled.store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * @return true if timers record.
+     */
+    static bool Enabled(){
+        return s_Enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Records one measurement into the histograms of the calling thread.
+     * @param stage Measured stage.
+     * @param ns Duration in nanoseconds.
+     */
+    static void Add(stage_t stage, uint64_t ns);
+
+    /**
+     * Writes count, mean, p50, p90, p99 and max of every stage which was measured, in ms.
+     * Must not be called while timers are recording.
+     * @param out Stream to be written to.
+     */
+    static void Report(std::ostream& out);
+
+    /**
+     * @return Name of a stage.
+     */
+    static const char* Name(stage_t stage);
+
+private:
+    inline static std::atomic<bool> s_Enabled{false};
+};
+
+#endif // STAGESTATS_H
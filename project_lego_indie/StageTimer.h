@@ -0,0 +1,57 @@
+/**
+ * @file StageTimer.h
+ * @brief Scoped timer feeding the stage statistics and the stage trace.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#ifndef STAGETIMER_H
+#define STAGETIMER_H
+
+#include <chrono>
+
+#include "StageStats.h"
+#include "StageTrace.h"
+
+/**
+ * @brief Measures the time until the end of the scope as one stage.
+ * While statistics, trace and ITT are disabled a timer costs three relaxed loads.
+ */
+class StageTimer {
+public:
+    explicit StageTimer(StageStats::stage_t stage) :
+        m_Stage(stage), m_Stats(StageStats::Enabled()), m_Trace(StageTrace::Enabled()), m_Itt(StageTrace::IttEnabled())
+    {
+        if(m_Itt)
+            StageTrace::IttBegin(m_Stage);
+        if(m_Stats || m_Trace)
+            m_Start = std::chrono::steady_clock::now();
+    }
+
+    ~StageTimer(){
+        if(m_Stats || m_Trace){
+            auto end = std::chrono::steady_clock::now();
+            if(m_Stats)
+                StageStats::Add(m_Stage, std::chrono::duration_cast<std::chrono::nanoseconds>(end - m_Start).count());
+            if(m_Trace)
+                StageTrace::Add(m_Stage, m_Start, end);
+        }
+        if(m_Itt)
+            StageTrace::IttEnd();
+    }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    StageStats::stage_t m_Stage;
+    bool m_Stats;
+    bool m_Trace;
+    bool m_Itt;
+    std::chrono::steady_clock::time_point m_Start;
+};
+
+#endif // STAGETIMER_H
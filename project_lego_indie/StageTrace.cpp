@@ -0,0 +1,132 @@
+/**
+ * @file StageTrace.cpp
+ * @brief Records the processing stages as chrome trace events and ITT tasks.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#include "StageTrace.h"
+
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <cstdio>
+
+// OpenCV installs its bundled ittnotify library but not the header, ITT is left out without it
+#if defined(HAVE_ITT) && __has_include(<ittnotify.h>)
+#define USE_ITT
+#include <ittnotify.h>
+#endif
+
+namespace {
+
+/**
+ * @brief One recorded span.
+ */
+struct Span {
+    StageStats::stage_t stage;
+    int64_t image;
+    int64_t start; // ns since the trace was enabled
+    int64_t dur;   // ns
+};
+
+/**
+ * @brief Spans of one thread.
+ */
+struct Buffer {
+    size_t tid;
+    std::vector<Span> spans;
+};
+
+std::chrono::steady_clock::time_point g_Origin;
+std::mutex g_Mutex;
+std::vector<std::unique_ptr<Buffer>> g_Buffers; // kept after their thread ended
+thread_local int64_t t_Image = -1;
+
+Buffer& local(){
+    thread_local Buffer* b = nullptr;
+    if(!b){
+        std::lock_guard<std::mutex> lock(g_Mutex);
+        g_Buffers.push_back(std::make_unique<Buffer>());
+        b = g_Buffers.back().get();
+        b->tid = g_Buffers.size();
+        b->spans.reserve(1 << 12);
+    }
+    return *b;
+}
+
+#ifdef USE_ITT
+__itt_domain* g_Domain = nullptr;
+__itt_string_handle* g_Names[StageStats::stage_count] = {};
+#endif
+
+} // namespace
+
+void StageTrace::Enable(){
+    g_Origin = std::chrono::steady_clock::now();
+    s_Enabled.store(true, std::memory_order_relaxed);
+}
+
+void StageTrace::InitItt(){
+#ifdef USE_ITT
+    g_Domain = __itt_domain_create("lenet");
+    if(!g_Domain || !g_Domain->flags)
+        return;
+    for(int s = 0; s < StageStats::stage_count; s++)
+        g_Names[s] = __itt_string_handle_create(StageStats::Name(static_cast<StageStats::stage_t>(s)));
+    s_Itt.store(true, std::memory_order_relaxed);
+#endif
+}
+
+void StageTrace::SetImage(int64_t image){
+    t_Image = image;
+}
+
+int64_t StageTrace::GetImage(){
+    return t_Image;
+}
+
+void StageTrace::Add(StageStats::stage_t stage, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end){
+    using std::chrono::nanoseconds;
+    using std::chrono::duration_cast;
+    local().spans.push_back({stage, t_Image, duration_cast<nanoseconds>(start - g_Origin).count(), duration_cast<nanoseconds>(end - start).count()});
+}
+
+void StageTrace::IttBegin(StageStats::stage_t stage){
+#ifdef USE_ITT
+    __itt_task_begin(g_Domain, __itt_null, __itt_null, g_Names[stage]);
+#else
+    (void)stage;
+#endif
+}
+
+void StageTrace::IttEnd(){
+#ifdef USE_ITT
+    __itt_task_end(g_Domain);
+#endif
+}
+
+bool StageTrace::Write(const std::filesystem::path& file){
+    std::FILE* f = std::fopen(file.string().c_str(), "w");
+    if(!f)
+        return false;
+
+    // complete events ("X") carry begin and duration of a span, timestamps are in us
+    std::lock_guard<std::mutex> lock(g_Mutex);
+    std::fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    std::fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"lenet\"}}");
+    for(const auto& b : g_Buffers){
+        std::fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"thread %zu\"}}", b->tid, b->tid);
+        for(const auto& s : b->spans){
+            std::fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"stage\",\"ph\":\"X\",\"pid\":1,\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"image\":%lld}}",
+                         StageStats::Name(s.stage), b->tid, s.start / 1e3, s.dur / 1e3, static_cast<long long>(s.image));
+        }
+    }
+    std::fprintf(f, "\n]}\n");
+
+    bool ok = !std::ferror(f);
+    return (std::fclose(f) == 0) && ok;
+}
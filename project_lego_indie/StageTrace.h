@@ -0,0 +1,97 @@
+/**
+ * @file StageTrace.h
+ * @brief Records the processing stages as chrome trace events and ITT tasks.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#ifndef STAGETRACE_H
+#define STAGETRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+
+#include "StageStats.h"
+
+/**
+ * @brief Stage trace.
+ * Every thread appends its spans to its own buffer, without locking. The buffers are written
+ * as one chrome trace event file (chrome://tracing, Perfetto) at the end of the run, every span
+ * carries the picture it belongs to. Builds with HAVE_ITT and ittnotify.h (ittapi) on the include
+ * path also send the spans to ITT while a collector (VTune) is attached, independent of the trace file.
+ */
+class StageTrace {
+public:
+
+    /**
+     * Starts recording, to be called before any work is started.
+     */
+    static void Enable();
+
+    /**
+     * @return true if spans are recorded.
+     */
+    static bool Enabled(){
+        return s_Enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Looks for an attached ITT collector, without one no ITT tasks are sent.
+     */
+    static void InitItt();
+
+    /**
+     * @return true if spans are sent to ITT.
+     */
+    static bool IttEnabled(){
+        return s_Itt.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Sets the picture the calling thread works on, spans without a picture get -1.
+     * @param image Index of the picture within its source.
+     */
+    static void SetImage(int64_t image);
+
+    /**
+     * @return Picture the calling thread works on.
+     */
+    static int64_t GetImage();
+
+    /**
+     * Records one span into the buffer of the calling thread.
+     * @param stage Traced stage.
+     * @param start Start of the span.
+     * @param end End of the span.
+     */
+    static void Add(StageStats::stage_t stage, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+    /**
+     * Begins an ITT task of the calling thread.
+     * @param stage Traced stage.
+     */
+    static void IttBegin(StageStats::stage_t stage);
+
+    /**
+     * Ends the last ITT task of the calling thread.
+     */
+    static void IttEnd();
+
+    /**
+     * Writes all recorded spans, must not be called while spans are recorded.
+     * @param file Trace file to be created.
+     * @return false if the file could not be written.
+     */
+    static bool Write(const std::filesystem::path& file);
+
+private:
+    inline static std::atomic<bool> s_Enabled{false};
+    inline static std::atomic<bool> s_Itt{false};
+};
+
+#endif // STAGETRACE_H
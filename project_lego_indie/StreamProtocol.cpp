@@ -0,0 +1,88 @@
+/**
+ * @file StreamProtocol.cpp
+ * @brief Binary request and result records used to drive the inspector from another process.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#include "StreamProtocol.h"
+
+#include "FilePrefetcher.h"
+
+static_assert(sizeof(StreamRequest) == 16, "request header must not contain padding");
+static_assert(sizeof(StreamRecord) == 8, "record header must not contain padding");
+static_assert(sizeof(FigureRecord) == 24, "figure record must not contain padding");
+
+bool checkRequest(const StreamRequest& req){
+    if(req.length == 0 || req.length > MaxStreamPayload)
+        return false;
+    if(req.type == StreamRequest::encoded || req.type == StreamRequest::path)
+        return true;
+    if(req.type == StreamRequest::raw)
+        return static_cast<uint64_t>(req.width) * req.height * 3 == req.length;
+    return false;
+}
+
+bool readRequest(std::FILE* in, StreamRequest& req, std::vector<uchar>& payload){
+    if(std::fread(&req, sizeof(req), 1, in) != 1 || !checkRequest(req))
+        return false;
+    payload.resize(req.length);
+    return std::fread(payload.data(), 1, payload.size(), in) == payload.size();
+}
+
+void fromRequest(const StreamRequest& req, SourcePic& src, const cv::Size& frameSize){
+    src.failed = false;
+    src.normalized = false;
+    src.pic = cv::Mat();
+    src.data = nullptr;
+    src.size = 0;
+
+    if(req.type == StreamRequest::raw){
+        if(static_cast<int>(req.width) == frameSize.width && static_cast<int>(req.height) == frameSize.height)
+            src.pic = cv::Mat(frameSize, CV_8UC3, src.buffer.data());
+        else
+            src.failed = true;
+        return;
+    }
+
+    if(req.type == StreamRequest::path){
+        src.name.assign(src.buffer.begin(), src.buffer.end());
+        if(!FilePrefetcher::ReadFile(src.name, src.buffer)){
+            src.failed = true;
+            return;
+        }
+    }
+    src.data = src.buffer.data();
+    src.size = src.buffer.size();
+}
+
+void appendRecord(std::string& out, uint32_t idx, const std::vector<FigureInspection>& res){
+    StreamRecord head;
+    head.idx = idx;
+    head.count = static_cast<uint32_t>(res.size());
+    out.append(reinterpret_cast<const char*>(&head), sizeof(head));
+    appendFigures(out, res);
+}
+
+void appendFigures(std::string& out, const std::vector<FigureInspection>& res){
+    for(const auto& fig : res){
+        FigureRecord rec;
+        rec.bits = ToBits(fig.result);
+        rec.location[0] = fig.location.center.x;
+        rec.location[1] = fig.location.center.y;
+        rec.location[2] = fig.location.size.width;
+        rec.location[3] = fig.location.size.height;
+        rec.location[4] = fig.location.angle;
+        out.append(reinterpret_cast<const char*>(&rec), sizeof(rec));
+    }
+}
+
+void appendFailedRecord(std::string& out, uint32_t idx){
+    StreamRecord head;
+    head.idx = idx;
+    head.count = StreamRecord::Failed;
+    out.append(reinterpret_cast<const char*>(&head), sizeof(head));
+}
@@ -0,0 +1,111 @@
+/**
+ * @file StreamProtocol.h
+ * @brief Binary request and result records used to drive the inspector from another process.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#ifndef STREAMPROTOCOL_H
+#define STREAMPROTOCOL_H
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "Inspector.h"
+#include "SourcePic.h"
+
+/**
+ * @brief Header of one request, followed by length payload bytes.
+ * The payload is either an encoded picture (any format imdecode understands), a raw
+ * BGR frame of width * height * 3 bytes or the path of a picture file readable by the
+ * inspector. All values are stored in host byte order.
+ */
+struct StreamRequest {
+    enum type_t : uint16_t { encoded = 0, raw = 1, path = 2 };
+
+    uint32_t length = 0;  // payload bytes following the header
+    uint16_t type = encoded;
+    uint16_t reserved = 0;
+    uint32_t width = 0;   // raw frames only
+    uint32_t height = 0;  // raw frames only
+};
+
+/**
+ * @brief Header of one result record, followed by count FigureRecord entries.
+ * Records are written in request order, idx counts the requests starting with 0.
+ */
+struct StreamRecord {
+    static constexpr uint32_t Failed = 0xFFFFFFFF; // count of a picture which could not be read
+
+    uint32_t idx = 0;
+    uint32_t count = 0;
+};
+
+/**
+ * @brief One found figure of a result record.
+ */
+struct FigureRecord {
+    uint16_t bits = 0;        // features as packed by ToBits()
+    uint16_t reserved = 0;
+    float location[5] = {};   // cx, cy, w, h, angle within the picture, zero in single figure mode
+};
+
+/**
+ * Largest payload accepted, guards against allocating garbage lengths.
+ */
+constexpr uint32_t MaxStreamPayload = 256u << 20;
+
+/**
+ * Checks that a request header describes a valid payload.
+ * @param req Request header.
+ * @return true if type and length are consistent.
+ */
+bool checkRequest(const StreamRequest& req);
+
+/**
+ * Reads the next request from a binary stream.
+ * @param in Stream to be read from.
+ * @param req [out] Request header.
+ * @param payload [out] Payload of the request, the buffer is reused.
+ * @return false at the end of the input or if the input is not a valid request.
+ */
+bool readRequest(std::FILE* in, StreamRequest& req, std::vector<uchar>& payload);
+
+/**
+ * Prepares the picture of a request for the inspection, raw frames are used in place.
+ * Path requests are named after the file, other requests keep the name set by the caller.
+ * @param req Valid request header.
+ * @param src [in/out] Picture whose buffer holds the payload of the request.
+ * @param frameSize Size raw frames must have.
+ */
+void fromRequest(const StreamRequest& req, SourcePic& src, const cv::Size& frameSize);
+
+/**
+ * Appends the result record of one picture.
+ * @param out Buffer to be appended to.
+ * @param idx Index of the request.
+ * @param res Found figures.
+ */
+void appendRecord(std::string& out, uint32_t idx, const std::vector<FigureInspection>& res);
+
+/**
+ * Appends one FigureRecord per found figure.
+ * @param out Buffer to be appended to.
+ * @param res Found figures.
+ */
+void appendFigures(std::string& out, const std::vector<FigureInspection>& res);
+
+/**
+ * Appends the record of a picture which could not be read.
+ * @param out Buffer to be appended to.
+ * @param idx Index of the request.
+ */
+void appendFailedRecord(std::string& out, uint32_t idx);
+
+#endif // STREAMPROTOCOL_H
@@ -0,0 +1,71 @@
+/**
+ * @file VideoSource.cpp
+ * @brief Class which decodes frames of a video file or camera in the background.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#include "VideoSource.h"
+
+#include <algorithm>
+#include <cctype>
+
+VideoSource::VideoSource(const std::string& src, size_t queueSize) : m_Frames(queueSize){
+    bool device = !src.empty() && std::all_of(src.begin(), src.end(), [](unsigned char c){ return std::isdigit(c); });
+    if(device)
+        m_Capture.open(std::stoi(src));
+    else
+        m_Capture.open(src);
+
+    // cameras often report no frame size before the first frame, so take the size from it
+    // the open state is kept, the capture belongs to the reader thread from now on
+    cv::Mat first;
+    m_Opened = m_Capture.isOpened() && m_Capture.read(first) && !first.empty();
+    if(!m_Opened){
+        m_Frames.Close();
+        return;
+    }
+    m_FrameSize = first.size();
+    m_Frames.Push(std::make_pair(size_t(0), first));
+    m_Reader = std::thread(&VideoSource::read, this);
+}
+
+VideoSource::~VideoSource(){
+    // unblocks the reader if the queue is full
+    m_Frames.Close();
+    if(m_Reader.joinable())
+        m_Reader.join();
+}
+
+bool VideoSource::IsOpened() const{
+    return m_Opened;
+}
+
+cv::Size VideoSource::GetFrameSize() const{
+    return m_FrameSize;
+}
+
+bool VideoSource::Next(size_t& idx, cv::Mat& frame){
+    std::pair<size_t, cv::Mat> next;
+    if(!m_Frames.Pop(next))
+        return false;
+    idx = next.first;
+    frame = next.second;
+    return true;
+}
+
+void VideoSource::read(){
+    // frame 0 was read by the constructor
+    for(size_t idx = 1; ; idx++){
+        // every frame gets its own buffer, it is handed over to the processing threads
+        cv::Mat frame;
+        if(!m_Capture.read(frame) || frame.empty())
+            break;
+        if(!m_Frames.Push(std::make_pair(idx, frame)))
+            break;
+    }
+    m_Frames.Close();
+}
@@ -0,0 +1,75 @@
+/**
+ * @file VideoSource.h
+ * @brief Class which decodes frames of a video file or camera in the background.
+ * @author Daniel Giritzer, Tobias Egger
+ * @copyright "THE BEER-WARE LICENSE" (Revision 42):
+ * <giri@nwrk.biz> wrote this file. As long as you retain this notice you
+ * can do whatever you want with this stuff. If we meet some day, and you think
+ * this stuff is worth it, you can buy me a beer in return Daniel Giritzer
+ */
+
+#ifndef VIDEOSOURCE_H
+#define VIDEOSOURCE_H
+
+#include <string>
+#include <thread>
+#include <utility>
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+#include <Object.h>
+
+#include "BoundedQueue.h"
+
+/**
+ * @brief Video frame source.
+ * A reader thread decodes frames into a bounded queue, so decoding overlaps with
+ * processing while the number of decoded frames in memory stays limited.
+ */
+class VideoSource : public giri::Object<VideoSource> {
+public:
+
+    /**
+     * CTor, starts decoding immediately.
+     * @param src Video file, or camera device index if the string only consists of digits.
+     * @param queueSize Maximum number of decoded frames waiting to be processed.
+     */
+    VideoSource(const std::string& src, size_t queueSize = 8);
+
+    /**
+     * DTor, stops the reader thread.
+     */
+    virtual ~VideoSource();
+
+    /**
+     * @return true if the video could be opened and delivered a first frame.
+     */
+    bool IsOpened() const;
+
+    /**
+     * @return Size of the decoded frames, taken from the first frame.
+     */
+    cv::Size GetFrameSize() const;
+
+    /**
+     * Takes the next decoded frame, may be called from multiple threads.
+     * @param idx [out] Frame number, starting with 0.
+     * @param frame [out] Decoded frame.
+     * @return false at the end of the stream.
+     */
+    bool Next(size_t& idx, cv::Mat& frame);
+
+    using SPtr = std::shared_ptr<VideoSource>;
+    using UPtr = std::unique_ptr<VideoSource>;
+    using WPtr = std::weak_ptr<VideoSource>;
+
+private:
+    void read();
+
+    cv::VideoCapture m_Capture;
+    bool m_Opened = false;
+    cv::Size m_FrameSize;
+    BoundedQueue<std::pair<size_t, cv::Mat>> m_Frames;
+    std::thread m_Reader;
+};
+
+#endif // VIDEOSOURCE_H
@@ -14,6 +14,21 @@
 #include <iostream>
 #include <filesystem>
 #include <optional>
+#include <algorithm>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <functional>
+#include <chrono>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
 
 // opencv
 #include <opencv2/core.hpp>
@@ -23,21 +38,26 @@
 // boost
 #include <boost/program_options.hpp>
 
-#include "IPicWorker.h"
-#include "FindFigure.h"
-#include "FindRightHand.h"
-#include "FindLeftHand.h"
-#include "FindRightFoot.h"
-#include "FindLeftFoot.h"
-#include "FindHead.h"
-#include "FindHat.h"
-#include "FindBodyPrint.h"
-#include "FindFacePrint.h"
-#include "FindLeftArm.h"
-#include "FindRightArm.h"
+#include "Inspector.h"
+#include "VideoSource.h"
+#include "FilePrefetcher.h"
+#include "PicArchive.h"
+#include "ResultCache.h"
+#include "Sha256.h"
+#include "JpegDecoder.h"
+#include "FigureWriter.h"
+#include "FigureReader.h"
+#include "StreamProtocol.h"
+#include "InspectionServer.h"
+#include "SourcePic.h"
+#include "EmbeddedPictures.h"
+#include "ReportWriter.h"
+#include "StageTimer.h"
 
 #include "ImgShow.h"
+#ifndef HEADLESS
 #include "Icon.h" // icon for window manager (embedded into executable for maximum portability)
+#endif
 
 namespace po = boost::program_options;
 
@@ -59,16 +79,81 @@ cv::Mat imreadChecked(const std::filesystem::path& f, cv::ImreadModes m){
     return img;
 }
 
+/**
+ * Reads picture from file, without a file the embedded picture is used. exits program on error
+ * @param f File to be read, empty to use the embedded picture.
+ * @param embedded Name of the embedded picture.
+ * @param fallback File to be read if the executable was built without the embedded picture.
+ */
+cv::Mat loadPicture(const std::filesystem::path& f, const std::string& embedded, const std::filesystem::path& fallback){
+    if(!f.empty())
+        return imreadChecked(f, cv::IMREAD_COLOR);
+    cv::Mat img = getEmbeddedPicture(embedded);
+    if(!img.empty())
+        return img;
+    return imreadChecked(fallback, cv::IMREAD_COLOR);
+}
+
+/**
+ * Decodes the picture if the source did not already. marks the picture as failed on error
+ * @param src Picture to be decoded.
+ * @param decoder Decoder of the calling thread, the picture shares its buffer.
+ * @param denom Scale denominator, the picture is decoded into pic if 1 and into the returned matrix only otherwise.
+ * @return Decoded picture, empty on error.
+ */
+cv::Mat decodePic(SourcePic& src, JpegDecoder& decoder, int denom = 1){
+    if(denom == 1 && !src.pic.empty())
+        return src.pic;
+    StageTimer timer(StageStats::decode);
+    cv::Mat pic;
+    if(!src.data || !decoder.Decode(src.data, src.size, denom, pic)){
+        src.failed = true;
+        return cv::Mat();
+    }
+    if(denom == 1)
+        src.pic = pic;
+    return pic;
+}
+
+/**
+ * Appends size, type and pixels of a picture to a digest.
+ * @param sha Digest to be updated.
+ * @param img Picture to be hashed.
+ */
+void hashPicture(Sha256& sha, const cv::Mat& img){
+    sha.Update(std::to_string(img.cols) + "x" + std::to_string(img.rows) + ":" + std::to_string(img.type()));
+    for(int y = 0; y < img.rows; y++)
+        sha.Update(img.ptr(y), img.cols * img.elemSize());
+}
+
 std::optional<po::variables_map> parseCmdLine(int argc, char** argv){
     // commandline options
     po::options_description desc("Allowed options");
     desc.add_options()
             ("help", "Print help.")
-            ("background", po::value<std::string>(), "Background image. (defaults to ./pic/Other/image_100.jpg)")
-            ("templdir", po::value<std::string>(), "Folder containing template files. (defaults to ./pic/templates)")
+            ("background", po::value<std::string>(), "Background image. (defaults to the embedded background, without one to ./pic/Other/image_100.jpg)")
+            ("templdir", po::value<std::string>(), "Folder containing template files. (defaults to the embedded templates, without them to ./pic/templates)")
+            ("embed", po::value<std::string>(), "Write the decoded background and templates into this header to be compiled into the executable and exit. (see make embed)")
             ("use_console", po::value<bool>(), "Print the result to console rather than using a GUI. (if not set or invalid a gui prompt will force you to select one)")
             ("show_steps", po::value<bool>(), "Visualize every working step. (if not set or invalid a gui prompt will force you to select one)")
-            ("images", po::value<std::string>(), "Image folder to be used. (if not set or invalid a gui prompt will force you to select one)");
+            ("fast_shift", po::value<bool>(), "Run the mean shift segmentation on a half resolution picture, about 9x faster, agrees with the full resolution on 79% of the pictures (make shift_test). (defaults to false)")
+            ("track", po::value<bool>(), "Reuse the figure transformation of the previous picture as long as the figure does not move, meant for video input. (defaults to false, best used with threads 1)")
+            ("multi", po::value<bool>(), "Inspect every figure of a picture instead of rejecting pictures with more than one figure. (defaults to false)")
+            ("prefetch", po::value<size_t>(), "Number of threads reading the next pictures of the image folder ahead of the processing. (defaults to 1)")
+            ("threads", po::value<size_t>(), "Number of images processed in parallel, 0 uses all cores. (defaults to 1, only used with use_console true and show_steps false)")
+            ("images", po::value<std::string>(), "Image folder to be used. (if not set or invalid a gui prompt will force you to select one)")
+            ("cache", po::value<std::string>(), "Folder of a result cache shared between runs, pictures already inspected with the same configuration are not decoded again. (only used with use_console true and show_steps false, not with track)")
+            ("export_figures", po::value<std::string>(), "Write all normalized figures into this file, for detector only runs with --figures.")
+            ("figures", po::value<std::string>(), "Figure file written by --export_figures, only the feature detectors are run on its figures instead of inspecting the image folder.")
+            ("decode_scale", po::value<int>(), "Search the figure on JPEGs decoded at 1/decode_scale resolution (1, 2, 4 or 8), the full picture is only decoded if a figure was found. (defaults to 1, not used with multi and track)")
+            ("pack", po::value<std::string>(), "Pack all pictures of the image folder into this archive and exit.")
+            ("archive", po::value<std::string>(), "Archive created by --pack to be inspected instead of the image folder.")
+            ("video", po::value<std::string>(), "Video file or camera device number to be used instead of the image folder. (frames must match the background size)")
+            ("trace", po::value<std::string>(), "Write begin and duration of every processing stage of every picture into this chrome trace event file (chrome://tracing, Perfetto).")
+            ("stats", po::value<bool>(), "Print count, mean, p50, p90, p99 and max duration of every processing stage to stderr at the end of the run. (defaults to false)")
+            ("format", po::value<std::string>(), "Console report format: text, jsonl, csv or bin, see ReportWriter.h. (defaults to text)")
+            ("stream", po::value<bool>(), "Read length prefixed pictures from stdin and write one binary result record per picture to stdout, see StreamProtocol.h. (defaults to false, implies use_console true and show_steps false)")
+            ("serve", po::value<std::string>(), "Listen on this unix domain socket and inspect the pictures sent by any number of clients until terminated, same records as stream. (implies use_console true and show_steps false, threads sets the number of workers)");
 
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -85,16 +170,52 @@ struct r_val {
     std::filesystem::path bg_img_path;
     std::filesystem::path path;
     std::filesystem::path templDir;
+    std::string video;
+    std::string format;
+    std::filesystem::path cache;
+    std::filesystem::path trace;
+    std::filesystem::path export_figures;
+    std::filesystem::path figures;
+    std::filesystem::path pack;
+    std::filesystem::path archive;
+    std::filesystem::path embed;
+    std::filesystem::path serve;
+    bool stream;
     bool show_steps;
     bool use_console;
+    bool fast_shift;
+    bool multi;
+    bool track;
+    bool stats;
+    int decode_scale;
+    size_t prefetch;
+    size_t threads;
 };
 
 r_val getFromCmdLine(po::variables_map vm){
-    std::filesystem::path bg_img_path = "./pic/Other/image_100.jpg";
+    std::filesystem::path bg_img_path = ""; // empty uses the embedded pictures
     std::filesystem::path path = "";
-    std::filesystem::path templDir = "./pic/templates";
+    std::filesystem::path templDir = "";
+    std::string video = "";
+    std::string format = "text";
+    std::filesystem::path cache = "";
+    std::filesystem::path trace = "";
+    std::filesystem::path export_figures = "";
+    std::filesystem::path figures = "";
+    std::filesystem::path pack = "";
+    std::filesystem::path archive = "";
+    std::filesystem::path embed = "";
+    std::filesystem::path serve = "";
+    bool stream = false;
     bool show_steps = false;
     bool use_console = true;
+    bool fast_shift = false;
+    bool multi = false;
+    bool track = false;
+    bool stats = false;
+    int decode_scale = 1;
+    size_t prefetch = 1;
+    size_t threads = 1;
 
     if(vm.count("background")){
         bg_img_path = vm["background"].as<std::string>();
@@ -102,8 +223,42 @@ r_val getFromCmdLine(po::variables_map vm){
     if(vm.count("images")){
         path = vm["images"].as<std::string>();
     }
-    if(!std::filesystem::exists(path)){
+    if(vm.count("cache")){
+        cache = vm["cache"].as<std::string>();
+    }
+    if(vm.count("export_figures")){
+        export_figures = vm["export_figures"].as<std::string>();
+    }
+    if(vm.count("figures")){
+        figures = vm["figures"].as<std::string>();
+    }
+    if(vm.count("pack")){
+        pack = vm["pack"].as<std::string>();
+    }
+    if(vm.count("archive")){
+        archive = vm["archive"].as<std::string>();
+    }
+    if(vm.count("video")){
+        video = vm["video"].as<std::string>();
+    }
+    if(vm.count("stream")){
+        stream = vm["stream"].as<bool>();
+    }
+    if(vm.count("serve")){
+        serve = vm["serve"].as<std::string>();
+    }
+    if(vm.count("embed")){
+        embed = vm["embed"].as<std::string>();
+    }
+    // binary records are written instead of the textual reports
+    const bool records = stream || !serve.empty();
+    if(!records && embed.empty() && video.empty() && figures.empty() && archive.empty() && !std::filesystem::exists(path)){
+#ifndef HEADLESS
         path = fl_dir_chooser("Choose image folder...", "./pic/", 1);
+#else
+        std::cerr << "Image folder does not exist: " << path.string() << std::endl;
+        exit(EXIT_FAILURE);
+#endif
     }
     if(vm.count("templdir")){
         templDir = vm["templdir"].as<std::string>();
@@ -111,28 +266,148 @@ r_val getFromCmdLine(po::variables_map vm){
     if(vm.count("show_steps")){
         show_steps =  vm["show_steps"].as<bool>();
     }
-    else{
+#ifndef HEADLESS
+    else if(!records && embed.empty()){
         fl_message_title("Visualize?");
         show_steps = fl_choice("Do you want to visualize all processing steps?", "No", "Yes", 0);
     }
+#endif
     if(vm.count("use_console")){
         use_console =  vm["use_console"].as<bool>();
     }
-    else{
+#ifndef HEADLESS
+    else if(!records && embed.empty()){
         fl_message_title("Use console?");
         use_console = fl_choice("Do you want to print the result to console rather than using a GUI?", "No", "Yes", 0);
     }
+#endif
+
+    // results go to stdout or the clients, nothing may block on a window
+    if(records && (show_steps || !use_console)){
+        std::cerr << "stream and serve require use_console true and show_steps false" << std::endl;
+        show_steps = false;
+        use_console = true;
+    }
+#ifdef HEADLESS
+    if(show_steps || !use_console){
+        std::cerr << "Headless build, using use_console true and show_steps false" << std::endl;
+        show_steps = false;
+        use_console = true;
+    }
+#endif
+
+    if(vm.count("fast_shift")){
+        fast_shift = vm["fast_shift"].as<bool>();
+    }
+    if(vm.count("multi")){
+        multi = vm["multi"].as<bool>();
+    }
+    if(vm.count("track")){
+        track = vm["track"].as<bool>();
+    }
+    if(vm.count("trace")){
+        trace = vm["trace"].as<std::string>();
+    }
+    if(vm.count("stats")){
+        stats = vm["stats"].as<bool>();
+    }
+    if(vm.count("format")){
+        format = vm["format"].as<std::string>();
+    }
+    ReportWriter::format_t fmt;
+    if(!ReportWriter::Parse(format, fmt)){
+        std::cerr << "Invalid format, using text: " << format << std::endl;
+        format = "text";
+    }
+    if(vm.count("decode_scale")){
+        decode_scale = vm["decode_scale"].as<int>();
+    }
+    if(decode_scale != 1 && decode_scale != 2 && decode_scale != 4 && decode_scale != 8){
+        std::cerr << "Invalid decode_scale, using 1: " << decode_scale << std::endl;
+        decode_scale = 1;
+    }
+    if(vm.count("prefetch")){
+        prefetch = std::max<size_t>(1, vm["prefetch"].as<size_t>());
+    }
+    if(vm.count("threads")){
+        threads = vm["threads"].as<size_t>();
+    }
+    if(threads == 0){
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    return {bg_img_path, path, templDir, video, format, cache, trace, export_figures, figures, pack, archive, embed, serve, stream, show_steps, use_console, fast_shift, multi, track, stats, decode_scale, prefetch, threads};
+}
+
+/**
+ * Inspects all pictures of a source using a pool of threads, every thread owns its own inspector.
+ * Reports are written in the order of the source, output is flushed whenever the next report is not ready yet.
+ * @param threads Number of worker threads.
+ * @param makeInspector Factory creating one inspector per thread.
+ * @param next Thread safe source, fills in the next picture, false if there is none left.
+ * @param inspect Inspects one picture and returns the formatted report.
+ * @param out Writer the reports are written to.
+ */
+template<typename Factory, typename Source, typename Inspect>
+void inspectParallel(size_t threads, Factory makeInspector, Source next, Inspect inspect, ReportWriter& out){
+    std::map<size_t, std::string> results;
+    std::mutex mtx;
+    std::condition_variable cond;
+    size_t running = threads;
+
+    std::vector<std::thread> pool;
+    for(size_t t = 0; t < threads; t++){
+        pool.emplace_back([&](){
+            Inspector::UPtr inspector = makeInspector();
+            SourcePic src;
+            while(next(src)){
+                auto str = inspect(*inspector, src);
+                {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    results[src.idx] = std::move(str);
+                }
+                cond.notify_all();
+            }
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                running--;
+            }
+            cond.notify_all();
+        });
+    }
 
-    return {bg_img_path, path, templDir, show_steps, use_console};
+    // write results in source order as soon as they are available
+    for(size_t i = 0; ; i++){
+        std::unique_lock<std::mutex> lock(mtx);
+        if(!results.count(i) && running != 0){
+            // end of a batch, hand out what was written so far
+            lock.unlock();
+            out.Flush();
+            lock.lock();
+        }
+        cond.wait(lock, [&](){ return results.count(i) || running == 0; });
+        auto res = results.find(i);
+        if(res == results.end())
+            break;
+        std::string str = std::move(res->second);
+        results.erase(res);
+        lock.unlock();
+        out.Write(str);
+    }
+
+    for(auto& t : pool)
+        t.join();
 }
 
 int main(int argc, char** argv)
 {
+#ifndef HEADLESS
     Fl::scheme("gleam");
 
     // wm icon
     auto icon = std::make_shared<Fl_RGB_Image>(icon_data, 128, 128, ImgShow::fl_imgtype::rgba, 0);
     ((Fl_Double_Window*)fl_message_icon()->parent())->icon(icon.get());
+#endif
     auto vm_b = parseCmdLine(argc, argv);
     if(vm_b == std::nullopt){
         return EXIT_SUCCESS;
@@ -140,14 +415,39 @@ int main(int argc, char** argv)
     auto vm = vm_b.value();
     auto config = getFromCmdLine(vm);
 
-    // read images
-    auto bg_img = imreadChecked(config.bg_img_path, cv::IMREAD_COLOR);
-    auto templFace = imreadChecked(config.templDir.append("template_face.png"), cv::IMREAD_COLOR);
-    auto templLarm = imreadChecked(config.templDir.remove_filename().append("template_left_arm.png"), cv::IMREAD_COLOR);
-    auto templRarm = imreadChecked(config.templDir.remove_filename().append("template_right_arm.png"), cv::IMREAD_COLOR);
+    // pack tool, no inspection at all
+    if(!config.pack.empty()){
+        std::vector<std::filesystem::path> files;
+        for (const auto & entry : std::filesystem::directory_iterator(config.path)) {
+            if(entry.is_regular_file())
+                files.push_back(entry.path());
+        }
+        if(!PicArchive::Pack(files, config.pack)){
+            std::cerr << "Could not pack the archive: " << config.pack.string() << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "Packed " << files.size() << " pictures into " << config.pack.string() << std::endl;
+        return EXIT_SUCCESS;
+    }
 
-    {
-        config.templDir.remove_filename();
+    // read images, the generator always reads the files
+    const std::filesystem::path bgFile = config.bg_img_path.empty() && !config.embed.empty() ? "./pic/Other/image_100.jpg" : config.bg_img_path;
+    const std::filesystem::path templDir = config.templDir.empty() && !config.embed.empty() ? "./pic/templates" : config.templDir;
+    auto templFile = [&](const char* name){ return templDir.empty() ? std::filesystem::path() : templDir / name; };
+    auto bg_img = loadPicture(bgFile, "background", "./pic/Other/image_100.jpg");
+    auto templFace = loadPicture(templFile("template_face.png"), "template_face", "./pic/templates/template_face.png");
+    auto templLarm = loadPicture(templFile("template_left_arm.png"), "template_left_arm", "./pic/templates/template_left_arm.png");
+    auto templRarm = loadPicture(templFile("template_right_arm.png"), "template_right_arm", "./pic/templates/template_right_arm.png");
+
+    // generator, no inspection at all
+    if(!config.embed.empty()){
+        if(!writeEmbeddedPictures(config.embed, {{"background", bg_img}, {"template_face", templFace},
+                                                 {"template_left_arm", templLarm}, {"template_right_arm", templRarm}})){
+            std::cerr << "Could not write the header: " << config.embed.string() << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << "Embedded background and templates into " << config.embed.string() << std::endl;
+        return EXIT_SUCCESS;
     }
 
 
@@ -155,94 +455,340 @@ int main(int argc, char** argv)
     if(!config.use_console){
         FreeConsole();
     }
+    if(config.stream || config.format == "bin"){
+        _setmode(_fileno(stdin), _O_BINARY);
+        _setmode(_fileno(stdout), _O_BINARY);
+    }
 #endif
 
-    IPicWorker::SPtr cutter = std::make_shared<FindFigure>(bg_img, config.show_steps);
-    IPicWorker::SPtr headFinder = std::make_shared<FindHead>(config.show_steps);
-    IPicWorker::SPtr hatFinder = std::make_shared<FindHat>(config.show_steps);
-    IPicWorker::SPtr leftHandFinder = std::make_shared<FindLeftHand>(config.show_steps);
-    IPicWorker::SPtr rightHandFinder = std::make_shared<FindRightHand>(config.show_steps);
-    IPicWorker::SPtr rightFootFinder = std::make_shared<FindRightFoot>(config.show_steps);
-    IPicWorker::SPtr leftFootFinder = std::make_shared<FindLeftFoot>(config.show_steps);
-    IPicWorker::SPtr bodyPrintFinder = std::make_shared<FindBodyPrint>(config.show_steps);
-    IPicWorker::SPtr facePrintFinder = std::make_shared<FindFacePrint>(templFace, config.show_steps);
-    IPicWorker::SPtr leftArmFinder = std::make_shared<FindLeftArm>(templLarm, config.show_steps);
-    IPicWorker::SPtr rightArmFinder = std::make_shared<FindRightArm>(templRarm, config.show_steps);
-
-
-    for (const auto & entry : std::filesystem::directory_iterator(config.path)) {
-
-        auto head = false, hat = false, leftHand = false, rightHand = false, leftArm = false, rightArm = false, leftFoot = false, rightFoot = false, facePrint = false, bodyPrint = false;
-        auto tmp = imreadChecked(entry, cv::IMREAD_COLOR);
-        if(!cutter->DoWork(tmp)){
-            std::stringstream strstr;
-            strstr << entry.path().string() << ": No indie detected!" << std::endl;
-            if(config.use_console){
-                std::cout << strstr.str();
+    if(config.stats)
+        StageStats::Enable();
+    if(!config.trace.empty())
+        StageTrace::Enable();
+    StageTrace::InitItt();
+
+    // previews only help pictures which are still encoded
+    const int previewScale = (config.multi || config.track) ? 1 : config.decode_scale;
+    auto makeInspector = [&](){
+        return std::make_unique<Inspector>(bg_img, templFace, templLarm, templRarm, config.show_steps,
+                                           config.fast_shift ? FindFigure::fast : FindFigure::precise, config.track, previewScale);
+    };
+
+    // results of previous runs, only the console reports can be served without the picture
+    // tracked results depend on the previous pictures, so they are never cached
+    ResultCache::UPtr cache;
+    if(!config.cache.empty() && config.track){
+        std::cerr << "The result cache is not used with track" << std::endl;
+    }
+    else if(!config.cache.empty() && config.use_console && !config.show_steps){
+        Sha256 sha;
+        sha.Update(ResultCache::Version);
+        for(const auto* img : {&bg_img, &templFace, &templLarm, &templRarm})
+            hashPicture(sha, *img);
+        sha.Update(std::string(config.fast_shift ? " fast" : " precise") + (config.multi ? " multi" : " single") + " preview " + std::to_string(previewScale));
+        sha.Update(makeInspector()->GetConfig());
+        cache = std::make_unique<ResultCache>(config.cache, sha.HexDigest());
+    }
+
+    // pictures come either from stdin, a figure file, a video / camera or from the image folder
+    std::function<bool(SourcePic&)> next;
+    FigureReader::UPtr figures;
+    PicArchive::UPtr archive;
+    VideoSource::UPtr video;
+    FilePrefetcher::UPtr prefetcher;
+    std::atomic<size_t> nextFile{0};
+    std::mutex streamMtx;
+    if(config.stream){
+        next = [&](SourcePic& src){
+            StreamRequest req;
+            {
+                std::lock_guard<std::mutex> lock(streamMtx);
+                if(!readRequest(stdin, req, src.buffer))
+                    return false;
+                src.idx = nextFile++;
             }
-            else {
-                ImgShow a(tmp, "Cut Picture", ImgShow::rgb, false);
-                fl_message_title("Result");
-                fl_message(strstr.str().c_str());
+            src.name = "stdin #" + std::to_string(src.idx);
+            fromRequest(req, src, bg_img.size());
+            return true;
+        };
+    }
+    else if(!config.figures.empty()){
+        figures = std::make_unique<FigureReader>(config.figures);
+        if(!figures->IsOpened()){
+            std::cerr << "Could not read the figure file: " << config.figures.string() << std::endl;
+            return EXIT_FAILURE;
+        }
+        next = [&](SourcePic& src){
+            src.idx = nextFile++;
+            if(src.idx >= figures->GetCount())
+                return false;
+            // the mapping is read only, detectors get their own copy
+            src.name = figures->GetName(src.idx);
+            src.failed = false;
+            figures->GetFigure(src.idx).copyTo(src.pic);
+            src.normalized = true;
+            src.location = figures->GetLocation(src.idx);
+            src.data = nullptr;
+            src.size = 0;
+            return true;
+        };
+    }
+    else if(!config.archive.empty()){
+        archive = std::make_unique<PicArchive>(config.archive);
+        if(!archive->IsOpened()){
+            std::cerr << "Could not read the archive: " << config.archive.string() << std::endl;
+            return EXIT_FAILURE;
+        }
+        // pictures are decoded straight from the mapping
+        next = [&](SourcePic& src){
+            src.idx = nextFile++;
+            if(src.idx >= archive->GetCount())
+                return false;
+            src.name = config.archive.string() + ":" + archive->GetName(src.idx);
+            src.data = archive->GetData(src.idx);
+            src.size = archive->GetSize(src.idx);
+            src.pic = cv::Mat();
+            src.failed = false;
+            return true;
+        };
+    }
+    else if(!config.video.empty()){
+        video = std::make_unique<VideoSource>(config.video, 2 * config.threads + 2);
+        if(!video->IsOpened()){
+            std::cerr << "Could not open the video: " << config.video << std::endl;
+            return EXIT_FAILURE;
+        }
+        if(video->GetFrameSize() != bg_img.size()){
+            std::cerr << "Video frame size does not match the background picture: " << config.video << std::endl;
+            return EXIT_FAILURE;
+        }
+        next = [&](SourcePic& src){
+            if(!video->Next(src.idx, src.pic))
+                return false;
+            src.name = config.video + " frame " + std::to_string(src.idx);
+            src.data = nullptr;
+            src.size = 0;
+            src.failed = false;
+            return true;
+        };
+    }
+    else if(config.serve.empty()){
+        std::vector<std::filesystem::path> files;
+        for (const auto & entry : std::filesystem::directory_iterator(config.path)) {
+            if(entry.is_regular_file())
+                files.push_back(entry.path());
+        }
+        // files are read ahead in the background, decoding stays with the processing threads
+        prefetcher = std::make_unique<FilePrefetcher>(std::move(files), config.prefetch, 2 * (config.threads + config.prefetch));
+        next = [&](SourcePic& src){
+            bool ok;
+            if(!prefetcher->Next(src.idx, src.name, src.buffer, ok))
+                return false;
+            if(!ok){
+                std::cerr << "Could not read the image: " << src.name << std::endl;
+                exit(EXIT_FAILURE);
             }
-            continue;
+            src.data = src.buffer.data();
+            src.size = src.buffer.size();
+            src.pic = cv::Mat();
+            src.failed = false;
+            return true;
+        };
+    }
+
+    FigureWriter::UPtr exporter;
+    if(!config.export_figures.empty() && config.figures.empty() && config.serve.empty()){
+        exporter = std::make_unique<FigureWriter>(config.export_figures);
+        if(!exporter->IsOpened()){
+            std::cerr << "Could not create the figure file: " << config.export_figures.string() << std::endl;
+            return EXIT_FAILURE;
         }
+    }
 
+    // finds and inspects the figures of one picture, single figure mode reports at most one figure
+    auto findFigures = [&](Inspector& inspector, SourcePic& src, size_t threads){
+        std::string key;
+        std::vector<FigureInspection> res;
+        if(src.failed)
+            return res;
+        if(src.normalized){
+            res.push_back({src.location, src.pic, inspector.CheckFeatures(src.pic)});
+            return res;
+        }
 
-        if(headFinder->DoWork(tmp)){
-            head = true;
-            hat = hatFinder->DoWork(tmp);
-            facePrint = facePrintFinder->DoWork(tmp);
+        // exported figures need the picture, so only store results then
+        if(cache && src.data){
+            key = Sha256::Of(src.data, src.size);
+            if(!exporter && cache->Get(key, res))
+                return res;
         }
 
-        if(leftHandFinder->DoWork(tmp)){
-            leftHand = true;
-            leftArm = true;
+        // decoded pictures land in the buffers of the thread's decoder
+        static thread_local JpegDecoder decoder;
+        if(config.multi){
+            cv::Mat pic = decodePic(src, decoder);
+            if(src.failed)
+                return res;
+            res = inspector.DoWorkAll(pic, threads);
+        }
+        else if(previewScale > 1 && src.pic.empty()){
+            // full picture is decoded only if the preview contains a figure
+            cv::Mat preview = decodePic(src, decoder, previewScale);
+            if(src.failed)
+                return res;
+            cv::Mat figure;
+            auto single = inspector.DoWork(preview, [&](){ return decodePic(src, decoder); }, figure);
+            if(src.failed)
+                return res;
+            src.pic = figure.empty() ? preview : figure;
+            if(single.figure)
+                res.push_back({cv::RotatedRect(), figure, single});
         }
         else{
-            leftArm = leftArmFinder->DoWork(tmp);
+            if(decodePic(src, decoder).empty())
+                return res;
+            auto single = inspector.DoWork(src.pic);
+            if(single.figure)
+                res.push_back({cv::RotatedRect(), src.pic, single});
         }
 
-        if(rightHandFinder->DoWork(tmp)){
-            rightHand = true;
-            rightArm = true;
+        if(!key.empty())
+            cache->Put(key, res);
+        return res;
+    };
+
+    // inspects one picture, every picture is exported, also if it could not be read
+    auto inspectPic = [&](Inspector& inspector, SourcePic& src, size_t threads){
+        auto res = findFigures(inspector, src, threads);
+        if(exporter){
+            std::vector<FigureWriter::Entry> entries;
+            for(const auto& fig : res)
+                entries.push_back({src.name, fig.location, fig.pic});
+            exporter->Write(src.idx, std::move(entries));
         }
-        else{
-            rightArm = rightArmFinder->DoWork(tmp);
-        }
-
-        leftFoot = leftFootFinder->DoWork(tmp);
-        rightFoot = rightFootFinder->DoWork(tmp);
-        bodyPrint = bodyPrintFinder->DoWork(tmp);
-
-        std::stringstream strstr;
-        strstr << "#############################################" << std::endl;
-        strstr << "File #" << entry.path().string() << std::endl;
-        strstr << "---------------------------------------------" << std::endl;
-        strstr << std::boolalpha;
-        strstr << "Hat       -> " << hat << std::endl;
-        strstr << "Head      -> " << head << std::endl;
-        strstr << "Left Hand -> " << leftHand << std::endl;
-        strstr << "Right Hand-> " << rightHand << std::endl; 
-        strstr << "Left Arm  -> " << leftArm << std::endl; 
-        strstr << "Right Arm -> " << rightArm << std::endl; 
-        strstr << "Left Foot -> " << leftFoot << std::endl; 
-        strstr << "Right Foot-> " << rightFoot << std::endl; 
-        strstr << "Face      -> " << facePrint << std::endl; 
-        strstr << "Body Print-> " << bodyPrint << std::endl; 
-        strstr << "#############################################" << std::endl;
-
-        if(config.use_console){
-            std::cout << strstr.str();
+        return res;
+    };
+
+    // the gui always shows text reports, stream and serve write their own records
+    ReportWriter::format_t fmt = ReportWriter::text;
+    if(config.use_console && !config.stream && config.serve.empty())
+        ReportWriter::Parse(config.format, fmt);
+    ReportWriter out(fmt, config.multi);
+
+    auto report = [&](const SourcePic& src, const std::vector<FigureInspection>& res, double seconds){
+        if(config.stream || !config.serve.empty()){
+            std::string rec;
+            if(src.failed)
+                appendFailedRecord(rec, static_cast<uint32_t>(src.idx));
+            else
+                appendRecord(rec, static_cast<uint32_t>(src.idx), res);
+            return rec;
         }
-        else{
-            ImgShow a(tmp, "Cut Picture", ImgShow::rgb, false);
-            fl_message_title("Result");
-            fl_message(strstr.str().c_str());
+        if(src.failed && fmt == ReportWriter::text){
+            std::cerr << "Could not read the image: " << src.name << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        return out.Format(src.idx, src.name, res, src.failed, seconds);
+    };
+
+    // inspects and reports one picture
+    auto process = [&](Inspector& inspector, SourcePic& src, size_t threads, std::vector<FigureInspection>& res){
+        StageTrace::SetImage(static_cast<int64_t>(src.idx));
+        auto start = std::chrono::steady_clock::now();
+        {
+            StageTimer timer(StageStats::picture);
+            res = inspectPic(inspector, src, threads);
+        }
+        return report(src, res, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    };
+
+    if(!config.serve.empty()){
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+        {
+            // inspectors stay resident, every worker keeps its own for all clients
+            InspectionServer server(config.serve, config.threads, makeInspector, [&](Inspector& inspector, SourcePic& src){
+                std::vector<FigureInspection> res;
+                return process(inspector, src, 1, res);
+            }, bg_img.size());
+            if(!server.IsOpened()){
+                std::cerr << "Could not listen on the socket: " << config.serve.string() << std::endl;
+                return EXIT_FAILURE;
+            }
+            server.Run();
+        }
+        // workers are joined, their statistics and traces are complete
+        if(config.stats)
+            StageStats::Report(std::cerr);
+        if(!config.trace.empty() && !StageTrace::Write(config.trace))
+            std::cerr << "Could not write the trace: " << config.trace.string() << std::endl;
+        return EXIT_SUCCESS;
+#else
+        std::cerr << "Unix domain sockets are not supported on this platform" << std::endl;
+        return EXIT_FAILURE;
+#endif
+    }
+    else if(config.threads > 1 && config.use_console && !config.show_steps){
+        // pictures are spread over the threads, so every picture uses one thread only
+        inspectParallel(config.threads, makeInspector, next, [&](Inspector& inspector, SourcePic& src){
+            std::vector<FigureInspection> res;
+            return process(inspector, src, 1, res);
+        }, out);
+    }
+    else{
+        auto inspector = makeInspector();
+        SourcePic src;
+        std::vector<FigureInspection> res;
+        auto flushed = std::chrono::steady_clock::now();
+        while(next(src)) {
+            // figures of one picture are checked in parallel instead
+            auto str = process(*inspector, src, config.threads, res);
+            if(config.use_console){
+                out.Write(str);
+                // a client waits for the record before sending the next picture, text reports and
+                // live sources are shown per picture, everything else at least once a second
+                auto now = std::chrono::steady_clock::now();
+                if(config.stream || fmt == ReportWriter::text || video || now - flushed > std::chrono::seconds(1)){
+                    out.Flush();
+                    flushed = now;
+                }
+            }
+#ifndef HEADLESS
+            else {
+                // mark the found figures on the picture shown by the gui
+                for(size_t f = 0; config.multi && f < res.size(); f++){
+                    cv::Point2f pts[4];
+                    res[f].location.points(pts);
+                    for(int j = 0; j < 4; j++)
+                        cv::line(src.pic, pts[j], pts[(j + 1) % 4], cv::Scalar(0,0,255), 2, cv::LINE_AA);
+                    cv::putText(src.pic, std::to_string(f), res[f].location.center, cv::FONT_HERSHEY_SIMPLEX, 0.8, cv::Scalar(0,0,255), 2);
+                }
+                ImgShow a(src.pic, "Cut Picture", ImgShow::rgb, false);
+                fl_message_title("Result");
+                fl_message(str.c_str());
+            }
+#endif
         }
     }
 
+    out.Flush();
+    if(exporter)
+        exporter->Close();
 
+    // how often processing waited on i/o, high values ask for more prefetch threads
+    if(prefetcher && config.use_console){
+        size_t taken = prefetcher->GetTaken();
+        std::cerr << "I/O waits: " << prefetcher->GetWaits() << " of " << taken << " pictures ("
+                  << (taken ? 100.0 * prefetcher->GetWaits() / taken : 0.0) << "%), "
+                  << prefetcher->GetWaitTime() * 1000 << " ms" << std::endl;
+    }
+    if(config.stats)
+        StageStats::Report(std::cerr);
+    if(!config.trace.empty() && !StageTrace::Write(config.trace))
+        std::cerr << "Could not write the trace: " << config.trace.string() << std::endl;
 
+#ifndef HEADLESS
     return(Fl::run());
-}
\ No newline at end of file
+#else
+    return EXIT_SUCCESS;
+#endif
+}